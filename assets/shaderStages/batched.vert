@@ -0,0 +1,30 @@
+#version 460 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aUv;
+
+// One per draw of a CG::DrawBatch, laid out like CG::Instance
+struct Draw
+{
+    mat4 model;
+    vec4 color;
+    vec4 uvTransform;
+};
+
+layout (std430, binding = 0) readonly buffer DrawData
+{
+    Draw draws[];
+};
+
+out vec2 uv;
+out vec4 color;
+
+uniform mat4 viewProjection;
+
+void main()
+{
+    const Draw draw = draws[gl_DrawID];
+
+    gl_Position = (viewProjection * draw.model * vec4(aPos, 1.0));
+    uv = ((aUv * draw.uvTransform.xy) + draw.uvTransform.zw);
+    color = draw.color;
+}
\ No newline at end of file
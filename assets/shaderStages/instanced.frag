@@ -0,0 +1,12 @@
+#version 460 core
+out vec4 FragColor;
+
+in vec2 uv;
+in vec4 color;
+
+uniform sampler2D baseMap;
+
+void main()
+{
+    FragColor = (texture(baseMap, uv) * color);
+}
\ No newline at end of file
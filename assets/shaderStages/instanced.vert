@@ -0,0 +1,20 @@
+#version 460 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aUv;
+
+// Per instance, see CG::Instance
+layout (location = 3) in mat4 aModel;
+layout (location = 7) in vec4 aColor;
+layout (location = 8) in vec4 aUvTransform;
+
+out vec2 uv;
+out vec4 color;
+
+uniform mat4 viewProjection;
+
+void main()
+{
+    gl_Position = (viewProjection * aModel * vec4(aPos, 1.0));
+    uv = ((aUv * aUvTransform.xy) + aUvTransform.zw);
+    color = aColor;
+}
\ No newline at end of file
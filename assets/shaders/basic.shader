@@ -3,4 +3,6 @@ vertex: "assets/shaderStages/basic.vert"
 #tessEvaluation:
 #geometry:
 fragment: "assets/shaderStages/basic.frag"
-#compute:
\ No newline at end of file
+#compute:
+#keywords: [ALPHA_TEST, FOG] # Each one is #defined in the variants that enable it, ex.: shader.getVariant({"FOG"})
+#warmUp: [[FOG], [ALPHA_TEST, FOG]] # Compiled ahead of time by shader.warmUp(queue)
\ No newline at end of file
@@ -0,0 +1,2 @@
+vertex: "assets/shaderStages/batched.vert"
+fragment: "assets/shaderStages/instanced.frag"
\ No newline at end of file
@@ -0,0 +1 @@
+compute: "assets/shaderStages/cull.comp"
\ No newline at end of file
@@ -0,0 +1,2 @@
+vertex: "assets/shaderStages/instanced.vert"
+fragment: "assets/shaderStages/instanced.frag"
\ No newline at end of file
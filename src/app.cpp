@@ -1,10 +1,14 @@
 #include "cg/vertex.hpp"
 #include "cg/window.hpp"
+#include "cg/application.hpp"
 #include "cg/vertexBuffer.hpp"
 #include "cg/indexBuffer.hpp"
 #include "cg/shader.hpp"
 #include "cg/texture.hpp"
 #include "cg/space.hpp"
+#include "cg/profiler.hpp"
+#include "cg/hotReloader.hpp"
+#include "cg/assetFile.hpp"
 
 // Settings:
 
@@ -32,13 +36,27 @@ Math::Vector3 cameraPosition = Math::Vector3(0, 0, 1000);
 Math::Vector3 cameraRotation = Math::Vector3::zero;
 Math::Vector3 cameraScale    = Math::Vector3::one;
 
+// State at the previous fixed step, rendering interpolates from it
+Math::Vector3 previousPosition = position, previousRotation = rotation, previousScale = scale;
+Math::Vector3 previousCameraPosition = cameraPosition, previousCameraRotation = cameraRotation, previousCameraScale = cameraScale;
+
 Math::Vector3 *boundInput = &position;
 
-void processUserInput() {
+Math::Vector3 interpolate(const Math::Vector3 &previous, const Math::Vector3 &current, float32_t alpha) {
+    return (previous + ((current - previous) * alpha));
+}
+
+void processUserInput(float64_t deltaTime) {
     using namespace CG;
 
-    const Window &window = *Window::getCurrentContext();
-    const float32_t variation = ((boundInput == &rotation) || (boundInput == &cameraRotation))? 0.1:1;
+    const auto focused = std::find_if(Window::getInstances().begin(), Window::getInstances().end(), [](const Window *window) {
+        return (glfwGetWindowAttrib(window->getWPtr(), GLFW_FOCUSED) == GLFW_TRUE);
+    });
+    if (focused == Window::getInstances().end()) return;
+
+    const Window &window = **focused;
+    const float32_t speed = ((boundInput == &rotation) || (boundInput == &cameraRotation))? 6:60; // Per second
+    const float32_t variation = static_cast<float32_t>(speed * deltaTime);
 
     if (glfwGetKey(window.getWPtr(), GLFW_KEY_1) || glfwGetKey(window.getWPtr(), GLFW_KEY_KP_1)) boundInput = &position;
     if (glfwGetKey(window.getWPtr(), GLFW_KEY_2) || glfwGetKey(window.getWPtr(), GLFW_KEY_KP_2)) boundInput = &rotation;
@@ -61,31 +79,70 @@ void processUserInput() {
 int main() {
     using namespace CG;
 
+    // Disk reads overlap window and context creation
+    for (const char *const path: {"./assets/shaders/basic.shader", "./assets/shaderStages/basic.vert", "./assets/shaderStages/basic.frag", "./assets/textures/container.jpg"}) {
+        AssetFile::prefetch(path);
+    }
+
     Window window("Main Window", 1024, 512);
     Window window1("Other Window", 512, 512);
-    std::vector<CG::Window *> toBeClosed;
+    Application application;
 
     VertexBuffer vbo(vertices);
     IndexBuffer ibo(triangles);
 
     Shader shader("./assets/shaders/basic.shader");
+    const UniformHandle mvpUniform = shader.getUniformHandle("mvp"), baseMapUniform = shader.getUniformHandle("baseMap");
 
     Texture texture("./assets/textures/container.jpg");
     texture.setMinificationMode(TextureMinificationMode::LinearMipmapLinear);
     texture.setMagnificationMode(TextureMagnificationMode::Linear);
     texture.setWrapModeU(TextureWrapMode::ClampToEdge);
     texture.setWrapModeV(TextureWrapMode::ClampToEdge);
-    texture.slot(10);
-    shader.setUniform<int32_t>("baseMap", texture.getSlot());
+
+    // Edits under assets/ show up without restarting
+    HotReloader hotReloader("./assets");
+    hotReloader.watch(shader);
+    hotReloader.watch(texture, "./assets/textures/container.jpg");
+
+    Profiler::setEnabled(true);
+    size_t stepsSinceTitleUpdate = 0;
+
+    application.setOnFixedUpdate([&](float64_t deltaTime) -> void {
+        previousPosition = position;
+        previousRotation = rotation;
+        previousScale = scale;
+        previousCameraPosition = cameraPosition;
+        previousCameraRotation = cameraRotation;
+        previousCameraScale = cameraScale;
+
+        processUserInput(deltaTime);
+
+        // Frame time overlay, once a second
+        if ((++stepsSinceTitleUpdate * deltaTime) >= 1.0) {
+            const ProfileStats cpu = Profiler::getStats("Window::render"), gpu = Profiler::getStats("Frame", true);
+            window.setTitle(std::format("Main Window | CPU {:.2f} ms (p99 {:.2f}) | GPU {:.2f} ms (p99 {:.2f})", cpu.average, cpu.p99, gpu.average, gpu.p99));
+            stepsSinceTitleUpdate = 0;
+        }
+    });
 
     const auto renderObj = [&]() -> void {
-        processUserInput();
+        hotReloader.update();
 
         const Window &window = *Window::getCurrentContext();
+        const float32_t alpha = static_cast<float32_t>(application.getInterpolation());
 
-        const Matrix4 modelMatrix = model<float32_t>(position, rotationFromEulerDeg(rotation), scale);
+        const Matrix4 modelMatrix = model<float32_t>(
+            interpolate(previousPosition, position, alpha),
+            rotationFromEulerDeg(interpolate(previousRotation, rotation, alpha)),
+            interpolate(previousScale, scale, alpha)
+        );
 
-        const Matrix4 viewMatrix = view<float32_t>(cameraPosition, rotationFromEulerDeg(cameraRotation), cameraScale);
+        const Matrix4 viewMatrix = view<float32_t>(
+            interpolate(previousCameraPosition, cameraPosition, alpha),
+            rotationFromEulerDeg(interpolate(previousCameraRotation, cameraRotation, alpha)),
+            interpolate(previousCameraScale, cameraScale, alpha)
+        );
 
         const Matrix4 projectionMatrix = usePerspectiveProjection?
             perspectiveDeg<float32_t>(60, window.getAspectRatio(), zNear, zFar):
@@ -94,29 +151,21 @@ int main() {
 
         const Matrix4 mvp = projectionMatrix * viewMatrix * modelMatrix;
 
-        shader.setUniform<Matrix4>("mvp", mvp);
+        shader.setUniform<Matrix4>(mvpUniform, mvp);
+        shader.setUniform<int32_t>(baseMapUniform, texture.bind());
 
         vbo.bind();
         ibo.bind();
         shader.bind();
 
+        CG_PROFILE_GPU_ZONE("Draw");
         glDrawElements(GL_TRIANGLES, triangles.getMemorySize(), static_cast<GLenum>(triangles.getTypeEnum()), nullptr); // Render
     };
 
     window.setOnRenderLoop(renderObj);
     window1.setOnRenderLoop(renderObj);
 
-    while (Window::getInstances().size() > 0) {
-        for (const auto &window: Window::getInstances()) {
-            window->renderLoop();
-            if (window->shouldClose()) toBeClosed.push_back(window);
-        }
-
-        for (const auto &window: toBeClosed) {
-            window->close();
-        }
-        toBeClosed.clear();
-    }
+    application.run();
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,472 @@
+#include <numeric>
+#include <spanstream>
+#include "cg/vertex.hpp"
+#include "cg/window.hpp"
+#include "cg/vertexBuffer.hpp"
+#include "cg/indexBuffer.hpp"
+#include "cg/shader.hpp"
+#include "cg/texture.hpp"
+#include "cg/space.hpp"
+#include "cg/profiler.hpp"
+#include "cg/mesh.hpp"
+#include "cg/instanceBuffer.hpp"
+#include "cg/drawBatch.hpp"
+#include "cg/renderQueue.hpp"
+#include "cg/frameArena.hpp"
+#include "cg/culling.hpp"
+#include "cg/assetFile.hpp"
+#include "cg/deleters.hpp"
+#include "cg/transformHierarchy.hpp"
+#include "cg/jobSystem.hpp"
+
+// Renders the demo scene headless as fast as possible, for throughput measurements and image based regression tests.
+// Usage: batchRender [--frames=N] [--width=W] [--height=H] [--api=native|egl|osmesa] [--output=path.png] [--trace=path.json]
+//                    [--quads=N] [--draw=instanced|indirect|culled|queue|per-object] [--uniforms=name|handle]
+//                    [--assets=mapped|stream] [--transforms=N] [--expect-zero-allocations] [--verify-culling]
+// With '--quads', N small quads are laid out in a grid and drawn in one instanced call, one multi draw indirect call, one indirect call
+// of the quads a compute shader found in view, one call each through the sorting render queue, or one call each in submission order.
+// '--uniforms' times a million uniform sets looked up by name against set through a handle, instead of rendering.
+// '--assets' times loading everything under ./assets through 'AssetFile' or through the std::ifstream reads it replaced, instead of rendering.
+// The first pass is a cold start when run right after the OS file cache was dropped (or a reboot), the passes after it are warm.
+// '--verify-culling', with '--draw=culled', fails the run when the last frame's GPU culled quads aren't the ones 'cullOnCpu' keeps.
+// '--expect-zero-allocations' fails the run when a frame past the warm up allocated, for CI. Needs a COUNT_ALLOCATIONS=1 build.
+// '--transforms' times a hierarchy of N nodes with 1% of them moving each frame, updated inline then through the job system, instead of rendering.
+
+const std::vector<CG::Vertex> vertices = {
+    {{-250.0f, +250.0f, +0.0f}, {0.0f, 1.0f}},
+    {{+250.0f, +250.0f, +0.0f}, {1.0f, 1.0f}},
+    {{-250.0f, -250.0f, +0.0f}, {0.0f, 0.0f}},
+    {{+250.0f, -250.0f, +0.0f}, {1.0f, 0.0f}}
+};
+
+const Math::IndexList triangles = Math::IndexList::create<uint8_t>(
+    0, 1, 2,
+    1, 2, 3
+);
+
+enum class QuadDrawMode {Instanced, Indirect, Culled, Queue, PerObject};
+enum class UniformLookup {None, Name, Handle};
+enum class AssetReader {None, Mapped, Stream};
+
+struct BatchSettings {
+    size_t frames = 1000;
+    int width = 1024, height = 512;
+    CG::ContextApi contextApi = CG::ContextApi::OSMesa;
+    std::filesystem::path output = "";
+    std::filesystem::path trace = ""; // Profiles the run and writes a Chrome trace
+    size_t quads = 0; // 0 renders the single demo quad
+    QuadDrawMode quadDrawMode = QuadDrawMode::Instanced;
+    UniformLookup uniformLookup = UniformLookup::None;
+    AssetReader assetReader = AssetReader::None;
+    size_t transforms = 0;
+    bool expectZeroAllocations = false;
+    bool verifyCulling = false;
+};
+
+BatchSettings parseArguments(int argc, char **argv) {
+    BatchSettings result;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view argument = argv[i];
+        const size_t separator = argument.find('=');
+        const std::string_view name = argument.substr(0, separator);
+        const std::string value((separator == std::string_view::npos)? std::string_view():argument.substr(separator + 1));
+
+        if (name == "--frames") result.frames = std::stoull(value);
+        else if (name == "--width") result.width = std::stoi(value);
+        else if (name == "--height") result.height = std::stoi(value);
+        else if (name == "--output") result.output = value;
+        else if (name == "--trace") result.trace = value;
+        else if (name == "--quads") result.quads = std::stoull(value);
+        else if (name == "--draw") {
+            if (value == "instanced") result.quadDrawMode = QuadDrawMode::Instanced;
+            else if (value == "indirect") result.quadDrawMode = QuadDrawMode::Indirect;
+            else if (value == "culled") result.quadDrawMode = QuadDrawMode::Culled;
+            else if (value == "queue") result.quadDrawMode = QuadDrawMode::Queue;
+            else if (value == "per-object") result.quadDrawMode = QuadDrawMode::PerObject;
+            else throw std::invalid_argument("Unknown draw mode \"" + value + '"');
+        }
+        else if (name == "--uniforms") {
+            if (value == "name") result.uniformLookup = UniformLookup::Name;
+            else if (value == "handle") result.uniformLookup = UniformLookup::Handle;
+            else throw std::invalid_argument("Unknown uniform lookup \"" + value + '"');
+        }
+        else if (name == "--assets") {
+            if (value == "mapped") result.assetReader = AssetReader::Mapped;
+            else if (value == "stream") result.assetReader = AssetReader::Stream;
+            else throw std::invalid_argument("Unknown asset reader \"" + value + '"');
+        }
+        else if (name == "--transforms") result.transforms = std::stoull(value);
+        else if (name == "--expect-zero-allocations") result.expectZeroAllocations = true;
+        else if (name == "--verify-culling") result.verifyCulling = true;
+        else if (name == "--api") {
+            if (value == "native") result.contextApi = CG::ContextApi::Native;
+            else if (value == "egl") result.contextApi = CG::ContextApi::Egl;
+            else if (value == "osmesa") result.contextApi = CG::ContextApi::OSMesa;
+            else throw std::invalid_argument("Unknown context api \"" + value + '"');
+        }
+        else throw std::invalid_argument("Unknown argument \"" + std::string(argument) + '"');
+    }
+
+    return result;
+}
+
+// Sets 'mvp' a million times, looking the name up on every set or through the handle resolved once
+void benchmarkUniformSets(CG::Shader &shader, UniformLookup lookup) {
+    using namespace CG;
+
+    constexpr size_t setCount = 1'000'000;
+    const UniformHandle handle = shader.getUniformHandle("mvp");
+    Matrix4 value = Matrix4::identity;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < setCount; ++i) {
+        value.at(0, 3) = static_cast<float32_t>(i); // Changes every time, so no set is elided
+        if (lookup == UniformLookup::Name) shader.setUniform<Matrix4>("mvp", value);
+        else shader.setUniform<Matrix4>(handle, value);
+    }
+    shader.flushUniforms();
+    const float64_t seconds = std::chrono::duration<float64_t>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << setCount << " uniform sets by " << ((lookup == UniformLookup::Name)? "name":"handle") << " in " << (seconds * 1000.0) << " ms, " << ((seconds * 1e9) / setCount) << " ns/set\n";
+}
+
+// Reads and parses one asset the way the loaders do: .shader files as YAML, images decoded, everything else as shader source text.
+// Returns a byte count, so nothing gets optimized out.
+size_t loadAsset(const std::filesystem::path &path, AssetReader reader) {
+    using namespace CG;
+
+    const std::filesystem::path extension = path.extension();
+    const bool image = ((extension == ".png") || (extension == ".jpg") || (extension == ".jpeg"));
+    int width = 0, height = 0, channels = 0;
+
+    if (reader == AssetReader::Mapped) {
+        const AssetFile file(path);
+        if (extension == ".shader") {
+            std::ispanstream stream(std::span<const char>(file.getText().data(), file.getSize()));
+            return YAML::Load(stream).size();
+        }
+        if (image) {
+            const std::unique_ptr<uint8_t, LoadedImagePixelsDeleter> pixels(stbi_load_from_memory(
+                reinterpret_cast<const stbi_uc *>(file.getBytes().data()), static_cast<int>(file.getSize()), &width, &height, &channels, 0
+            ));
+            return ((pixels == nullptr)? 0:static_cast<size_t>(width * height * channels));
+        }
+        return std::string(file.getText()).size();
+    }
+
+    // Before 'AssetFile': YAML::LoadFile, stbi_load with its own fopen, and shader sources appended line by line
+    if (extension == ".shader") return YAML::LoadFile(path.string()).size();
+    if (image) {
+        const std::unique_ptr<uint8_t, LoadedImagePixelsDeleter> pixels(stbi_load(path.string().c_str(), &width, &height, &channels, 0));
+        return ((pixels == nullptr)? 0:static_cast<size_t>(width * height * channels));
+    }
+
+    std::ifstream stream(path);
+    std::string text, line;
+    while (std::getline(stream, line)) {
+        text.append(line);
+        text.push_back('\n');
+    }
+    return text.size();
+}
+
+void benchmarkAssetLoading(AssetReader reader) {
+    constexpr size_t passCount = 5;
+
+    std::vector<std::filesystem::path> paths;
+    for (const auto &entry: std::filesystem::recursive_directory_iterator("./assets")) {
+        if (entry.is_regular_file()) paths.push_back(entry.path());
+    }
+    std::sort(paths.begin(), paths.end());
+
+    std::vector<float64_t> passMilliseconds;
+    size_t loadedBytes = 0;
+    for (size_t pass = 0; pass < passCount; ++pass) {
+        const auto start = std::chrono::steady_clock::now();
+        loadedBytes = 0;
+        for (const auto &path: paths) loadedBytes += loadAsset(path, reader);
+        passMilliseconds.push_back(std::chrono::duration<float64_t, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    const float64_t warmMilliseconds = (std::accumulate((passMilliseconds.begin() + 1), passMilliseconds.end(), 0.0) / (passCount - 1));
+    std::cout << paths.size() << " assets through " << ((reader == AssetReader::Mapped)? "AssetFile":"std::ifstream") << ", " << loadedBytes << " bytes loaded: "
+        << "first pass " << passMilliseconds[0] << " ms, warm " << warmMilliseconds << " ms\n";
+}
+
+// Scene like hierarchy: objects of 100 nodes, each a root with a 4 way tree of parts under it.
+// Every frame moves a different 1% of the nodes, so some moves are roots dragging a whole object and most are single parts.
+void benchmarkTransforms(size_t nodeCount, size_t frameCount) {
+    using namespace CG;
+
+    constexpr size_t objectSize = 100;
+    TransformHierarchy hierarchy;
+    std::vector<TransformId> nodes;
+    nodes.reserve(nodeCount);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        const size_t part = (i % objectSize);
+        const TransformId parent = ((part == 0)? TransformId():nodes[i - part + ((part - 1) / 4)]);
+        nodes.push_back(hierarchy.create(parent, Vector3(static_cast<float32_t>(part), 0.0f, 0.0f)));
+    }
+    hierarchy.update();
+
+    // Workers started once, as an application would, so the parallel updates only pay for scheduling jobs
+    const size_t movingCount = std::max<size_t>((nodeCount / 100), 1);
+    for (const bool parallel: {false, true}) {
+        if (parallel) JobSystem::start();
+
+        float64_t seconds = 0.0;
+        size_t updatedCount = 0;
+
+        for (size_t frame = 0; frame < frameCount; ++frame) {
+            for (size_t i = 0; i < movingCount; ++i) {
+                const size_t node = (((i * 2654435761u) + (frame * 40503u)) % nodeCount); // Scattered, deterministic
+                hierarchy.setPosition(nodes[node], Vector3(static_cast<float32_t>(frame), static_cast<float32_t>(i), 0.0f));
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+            hierarchy.update(parallel);
+            seconds += std::chrono::duration<float64_t>(std::chrono::steady_clock::now() - start).count();
+            updatedCount += hierarchy.getUpdatedCount();
+        }
+
+        std::cout << nodeCount << " transforms, " << movingCount << " moving, " << (parallel? (JobSystem::getWorkerCount() + 1):1) << " thread(s): " << ((seconds * 1000.0) / frameCount) << " ms/update, "
+            << (updatedCount / frameCount) << " world matrices recomputed per update\n";
+
+        if (parallel) JobSystem::stop();
+    }
+}
+
+// Same set of draws both ways, the shader writes them in whatever order its invocations finish
+bool verifyCulling(const CG::GpuCuller &culler, const CG::Matrix4 &viewProjection) {
+    using namespace CG;
+
+    std::vector<DrawElementsIndirectCommand> commands;
+    std::vector<Instance> expected;
+    cullOnCpu(Frustum::fromViewProjection(viewProjection), culler.getObjects(), commands, expected);
+    std::vector<Instance> actual = culler.readDraws();
+
+    const auto byBytes = [](const Instance &a, const Instance &b) {return (std::memcmp(&a, &b, sizeof(Instance)) < 0);};
+    std::sort(expected.begin(), expected.end(), byBytes);
+    std::sort(actual.begin(), actual.end(), byBytes);
+
+    std::vector<Instance> missing, extra;
+    std::set_difference(expected.begin(), expected.end(), actual.begin(), actual.end(), std::back_inserter(missing), byBytes);
+    std::set_difference(actual.begin(), actual.end(), expected.begin(), expected.end(), std::back_inserter(extra), byBytes);
+
+    std::cout << "Culling check: " << actual.size() << " drawn on the GPU, " << expected.size() << " kept on the CPU, "
+        << missing.size() << " missing, " << extra.size() << " extra\n";
+    return (missing.empty() && extra.empty());
+}
+
+int main(int argc, char **argv) {
+    using namespace CG;
+
+    const BatchSettings settings = parseArguments(argc, argv);
+    Profiler::setEnabled(!settings.trace.empty());
+
+    if (settings.assetReader != AssetReader::None) {
+        benchmarkAssetLoading(settings.assetReader);
+        return 0;
+    }
+    if (settings.transforms != 0) {
+        benchmarkTransforms(settings.transforms, settings.frames);
+        return 0;
+    }
+
+    Window window("Batch Render", settings.width, settings.height, {.headless = true, .contextApi = settings.contextApi});
+    if (!window.exists()) return 1;
+
+    VertexBuffer vbo(vertices);
+    IndexBuffer ibo(triangles);
+
+    Shader shader("./assets/shaders/basic.shader");
+    const UniformHandle mvpUniform = shader.getUniformHandle("mvp"), baseMapUniform = shader.getUniformHandle("baseMap");
+
+    if (settings.uniformLookup != UniformLookup::None) {
+        benchmarkUniformSets(shader, settings.uniformLookup);
+        return 0;
+    }
+
+    Texture texture("./assets/textures/container.jpg");
+    texture.setMinificationMode(TextureMinificationMode::LinearMipmapLinear);
+    texture.setMagnificationMode(TextureMagnificationMode::Linear);
+
+    // Grid of quads for the draw mode comparison, spread over the same area as the demo quad
+    const size_t gridSide = static_cast<size_t>(std::ceil(std::sqrt(static_cast<float64_t>(settings.quads))));
+    const float32_t cellSize = ((gridSide == 0)? 0.0f:(1000.0f / gridSide));
+    std::vector<Instance> quads(settings.quads);
+    for (size_t i = 0; i < quads.size(); ++i) {
+        const Math::Vector3 position(((i % gridSide) * cellSize) - 500.0f, ((i / gridSide) * cellSize) - 500.0f, 0.0f);
+        quads[i].model = model<float32_t>(position, rotationFromEulerDeg(Math::Vector3::zero), Math::Vector3::fullOf(cellSize / 500.0f * 0.8f));
+        quads[i].color = Color::fromHSVA_Deg(static_cast<float32_t>((i * 37) % 360), 0.5f, 1.0f);
+    }
+
+    std::optional<Mesh> quadMesh;
+    std::optional<InstanceBuffer<Instance>> instances;
+    std::optional<DrawBatch> drawBatch;
+    std::optional<GpuCuller> culler;
+    BatchMesh batchQuad;
+    std::optional<Shader> quadShader;
+    UniformHandle viewProjectionUniform, quadBaseMapUniform;
+    if (!quads.empty()) {
+        quadMesh.emplace(vertices, triangles);
+
+        if (settings.quadDrawMode == QuadDrawMode::Instanced) {
+            instances.emplace(quads.size());
+            quadShader.emplace("./assets/shaders/instanced.shader");
+        }
+        else if (settings.quadDrawMode == QuadDrawMode::Indirect) {
+            drawBatch.emplace(quads.size());
+            batchQuad = drawBatch->addMesh(vertices, triangles);
+            quadShader.emplace("./assets/shaders/batched.shader");
+        }
+        else if (settings.quadDrawMode == QuadDrawMode::Culled) {
+            drawBatch.emplace();
+            batchQuad = drawBatch->addMesh(vertices, triangles);
+            quadShader.emplace("./assets/shaders/batched.shader");
+
+            // Uploaded once, the grid doesn't move
+            culler.emplace();
+            const Bounds quadBounds = {Math::Vector3::zero, (250.0f * std::sqrt(2.0f))}; // Through the corners
+            for (const Instance &quad: quads) culler->add(batchQuad, quadBounds, quad);
+        }
+
+        if (quadShader) {
+            viewProjectionUniform = quadShader->getUniformHandle("viewProjection");
+            quadBaseMapUniform = quadShader->getUniformHandle("baseMap");
+        }
+    }
+
+    RenderQueue renderQueue;
+    Matrix4 viewProjection = Matrix4::identity; // Of the last frame
+
+    size_t frame = 0;
+    const auto renderFrame = [&]() -> void {
+        // Deterministic per frame, so a given frame count always produces the same image
+        const Math::Vector3 rotation = Math::Vector3(0, 0, static_cast<float32_t>(frame % 360));
+
+        viewProjection =
+            perspectiveDeg<float32_t>(60, (static_cast<float32_t>(settings.width) / settings.height), 1.0f, 10000.0f) *
+            view<float32_t>(Math::Vector3(0, 0, 1000), rotationFromEulerDeg(Math::Vector3::zero), Math::Vector3::one);
+
+        if (quads.empty()) {
+            shader.setUniform<Matrix4>(mvpUniform, viewProjection * model<float32_t>(Math::Vector3::zero, rotationFromEulerDeg(rotation), Math::Vector3::one));
+            shader.setUniform<int32_t>(baseMapUniform, texture.bind());
+
+            vbo.bind();
+            ibo.bind();
+            shader.bind();
+
+            CG_PROFILE_GPU_ZONE("Draw");
+            glDrawElements(GL_TRIANGLES, triangles.getMemorySize(), static_cast<GLenum>(triangles.getTypeEnum()), nullptr);
+            return;
+        }
+
+        if (quadShader) {
+            if (culler) culler->cull(viewProjection); // Binds the cull shader, so before the draw shader
+
+            quadShader->setUniform<Matrix4>(viewProjectionUniform, viewProjection);
+            quadShader->setUniform<int32_t>(quadBaseMapUniform, texture.bind());
+            quadShader->bind();
+
+            // Instanced and indirect re-send every quad each frame, as dynamic objects would. Culled ones stay on the GPU.
+            CG_PROFILE_GPU_ZONE("Draw");
+            if (instances) {
+                instances->setData(quads);
+                drawInstanced(*quadMesh, *instances);
+            }
+            else if (culler) culler->submit(*drawBatch);
+            else {
+                for (const Instance &quad: quads) drawBatch->draw(batchQuad, quad);
+                drawBatch->submit();
+            }
+            return;
+        }
+
+        if (settings.quadDrawMode == QuadDrawMode::Queue) {
+            for (const Instance &quad: quads) {
+                RenderItem item;
+                item.shader = &shader;
+                item.mesh = &*quadMesh;
+                item.texture = &texture;
+                item.textureUniform = baseMapUniform;
+                item.transformUniform = mvpUniform;
+                item.transform = (viewProjection * quad.model);
+                renderQueue.submit(item);
+            }
+
+            CG_PROFILE_GPU_ZONE("Draw");
+            renderQueue.execute();
+            return;
+        }
+
+        shader.setUniform<int32_t>(baseMapUniform, texture.bind());
+        quadMesh->bind();
+
+        CG_PROFILE_GPU_ZONE("Draw");
+        for (const Instance &quad: quads) {
+            shader.setUniform<Matrix4>(mvpUniform, viewProjection * quad.model);
+            shader.bind();
+            glDrawElements(GL_TRIANGLES, quadMesh->getIndexCount(), quadMesh->getIndexType(), nullptr);
+        }
+    };
+    window.setOnRenderLoop(renderFrame);
+
+    // The first frames still fill caches and grow buffers, allocations are counted past them
+    constexpr size_t warmUpFrames = 10;
+    size_t steadyAllocations = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (frame = 0; frame < settings.frames; ++frame) {
+        if (frame == warmUpFrames) steadyAllocations = AllocationCounter::getCount();
+        window.render();
+    }
+    steadyAllocations = ((settings.frames > warmUpFrames)? (AllocationCounter::getCount() - steadyAllocations):0);
+    glFinish(); // Count the GPU work, not just the submission
+    const float64_t seconds = std::chrono::duration<float64_t>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << settings.frames << " frames in " << seconds << " s: " << (settings.frames / seconds) << " fps, " << ((seconds * 1000.0) / settings.frames) << " ms/frame\n";
+    if (!quads.empty()) std::cout << quads.size() << " quads, " << (instances? "instanced":(culler? "culled":(drawBatch? "indirect":((settings.quadDrawMode == QuadDrawMode::Queue)? "queued":"per object")))) << ", " << ((settings.frames * quads.size()) / seconds) << " quads/s\n";
+    if (instances) std::cout << "Instance stream stalls: " << instances->getStream().getStallCount() << '\n';
+    if (culler) std::cout << "Last frame: " << culler->readDrawCount() << " of " << culler->getObjectCount() << " quads in view\n";
+    if (settings.quadDrawMode == QuadDrawMode::Queue) {
+        const RenderQueueStats &queueStats = renderQueue.getStats();
+        std::cout << "Last frame: " << queueStats.drawCount << " draws, " << queueStats.programChanges << " program, " << queueStats.textureChanges << " texture, " << queueStats.meshChanges << " mesh changes\n";
+    }
+    if (AllocationCounter::isEnabled() && (settings.frames > warmUpFrames)) {
+        std::cout << "Heap allocations: " << (static_cast<float64_t>(steadyAllocations) / (settings.frames - warmUpFrames)) << " per frame past the first " << warmUpFrames << '\n';
+    }
+    std::cout << "Uniforms: " << shader.getUploadedUniformCount() << " uploaded, " << shader.getElidedUniformCount() << " unchanged and elided\n";
+
+    if (!settings.output.empty()) window.savePng(settings.output);
+    if (!settings.trace.empty()) {
+        std::cout << Profiler::formatStats();
+        Profiler::writeChromeTrace(settings.trace);
+    }
+
+    if (settings.verifyCulling) {
+        if (!culler) {
+            std::cerr << "--verify-culling needs --draw=culled and --quads\n";
+            return 1;
+        }
+        if (!verifyCulling(*culler, viewProjection)) return 1;
+    }
+
+    if (settings.expectZeroAllocations) {
+        if (!AllocationCounter::isEnabled()) {
+            std::cerr << "--expect-zero-allocations needs a build with COUNT_ALLOCATIONS=1\n";
+            return 1;
+        }
+        if (settings.frames <= warmUpFrames) {
+            std::cerr << "--expect-zero-allocations needs more than " << warmUpFrames << " frames\n";
+            return 1;
+        }
+        if (steadyAllocations > 0) {
+            std::cerr << steadyAllocations << " heap allocations past the first " << warmUpFrames << " frames, expected none\n";
+            return 1;
+        }
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include "application.hpp"
+#include "jobSystem.hpp"
+
+namespace CG {
+    void Application::applySwapIntervals() {
+        // Render threads each wait for their own vblank in parallel, main thread windows would add theirs up
+        bool mainThreadSynced = false;
+        for (const auto &window: Window::getInstances()) {
+            bool synced = false;
+            if (framePacing == FramePacing::VSync) {
+                synced = (window->hasRenderThread() || !mainThreadSynced);
+                if (!window->hasRenderThread()) mainThreadSynced = true;
+            }
+            window->setSwapInterval(synced? 1:0);
+        }
+    }
+
+    bool Application::isIdle() const {
+        for (const auto &window: Window::getInstances()) {
+            if (glfwGetWindowAttrib(window->getWPtr(), GLFW_ICONIFIED) == GLFW_FALSE) return false;
+        }
+        return true;
+    }
+
+    void Application::pace(Clock::time_point frameStart) {
+        const bool idle = isIdle(); // Minimized windows don't block on swap, so vsync alone would spin
+        if ((!idle) && ((framePacing == FramePacing::VSync) || (framePacing == FramePacing::Unlimited))) return;
+
+        const float64_t fps = (idle? idleFps:targetFps);
+        const Clock::time_point deadline = (frameStart + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float64_t>(1.0 / fps)));
+
+        if ((framePacing != FramePacing::Adaptive) || idle) {
+            std::this_thread::sleep_until(deadline);
+            return;
+        }
+
+        // Sleep short by the usual oversleep, learn from how far off this one was, then yield up to the deadline
+        const Clock::time_point wakeTarget = (deadline - std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float64_t>(sleepOvershoot)));
+        if (wakeTarget > Clock::now()) {
+            std::this_thread::sleep_until(wakeTarget);
+
+            const float64_t overshoot = std::chrono::duration<float64_t>(Clock::now() - wakeTarget).count();
+            sleepOvershoot = std::max(0.0, ((sleepOvershoot * 0.9) + (overshoot * 0.1)));
+        }
+
+        while (Clock::now() < deadline) std::this_thread::yield();
+    }
+
+    void Application::run() {
+        quitRequested = false;
+        while ((!quitRequested) && (!Window::getInstances().empty())) runFrame();
+    }
+
+    void Application::runFrame() {
+        CG_PROFILE_ZONE("Application::runFrame");
+
+        const Clock::time_point frameStart = Clock::now();
+        frameTime = (started? std::chrono::duration<float64_t>(frameStart - previousFrameStart).count():fixedTimestep);
+        previousFrameStart = frameStart;
+        started = true;
+
+        glfwPollEvents();
+
+        accumulator += std::min(frameTime, maxFrameTime);
+        size_t steps = 0;
+        while ((accumulator >= fixedTimestep) && (steps < maxFixedStepsPerFrame)) {
+            CG_PROFILE_ZONE("Fixed update");
+            onFixedUpdate(fixedTimestep);
+            accumulator -= fixedTimestep;
+            ++steps;
+        }
+        if (steps == maxFixedStepsPerFrame) accumulator = std::min(accumulator, fixedTimestep); // Drop what couldn't be caught up
+        interpolation = std::clamp((accumulator / fixedTimestep), 0.0, 1.0);
+
+        JobSystem::executeMainThreadJobs();
+        if (resourceQueue) resourceQueue->execute();
+        applySwapIntervals();
+
+        for (const auto &window: Window::getInstances()) {
+            if (window->hasRenderThread()) window->requestRender();
+        }
+        for (const auto &window: Window::getInstances()) {
+            if (!window->hasRenderThread()) window->render();
+        }
+
+        for (const auto &window: Window::getInstances()) {
+            if (window->hasRenderThread()) window->waitForRender();
+        }
+
+        // Backwards, closing erases the window from instances
+        const std::vector<Window *> &windows = Window::getInstances();
+        for (size_t i = windows.size(); i-- > 0;) {
+            if (windows[i]->shouldClose()) windows[i]->close();
+        }
+
+        ++frameCount;
+
+        CG_PROFILE_ZONE("Frame pacing");
+        pace(frameStart);
+    }
+
+    void Application::quit() noexcept {quitRequested = true;}
+
+    ResourceQueue &Application::getResourceQueue() {
+        if (!resourceQueue) resourceQueue = std::make_unique<ResourceQueue>();
+        return *resourceQueue;
+    }
+
+    const std::function<void(float64_t)> &Application::getOnFixedUpdate() const {return onFixedUpdate;}
+    void Application::setOnFixedUpdate(const std::function<void(float64_t)> &value) {onFixedUpdate = value;}
+
+    float64_t Application::getFixedTimestep() const noexcept {return fixedTimestep;}
+
+    void Application::setFixedTimestep(float64_t value) {
+        ASSERT(value > 0.0);
+        fixedTimestep = value;
+    }
+
+    size_t Application::getMaxFixedStepsPerFrame() const noexcept {return maxFixedStepsPerFrame;}
+
+    void Application::setMaxFixedStepsPerFrame(size_t value) {
+        ASSERT(value > 0);
+        maxFixedStepsPerFrame = value;
+    }
+
+    FramePacing Application::getFramePacing() const noexcept {return framePacing;}
+    void Application::setFramePacing(FramePacing value) {framePacing = value;}
+
+    float64_t Application::getTargetFps() const noexcept {return targetFps;}
+
+    void Application::setTargetFps(float64_t value) {
+        ASSERT(value > 0.0);
+        targetFps = value;
+    }
+
+    float64_t Application::getIdleFps() const noexcept {return idleFps;}
+
+    void Application::setIdleFps(float64_t value) {
+        ASSERT(value > 0.0);
+        idleFps = value;
+    }
+
+    float64_t Application::getInterpolation() const noexcept {return interpolation;}
+    float64_t Application::getFrameTime() const noexcept {return frameTime;}
+    uint64_t Application::getFrameCount() const noexcept {return frameCount;}
+}
\ No newline at end of file
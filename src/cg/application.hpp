@@ -0,0 +1,80 @@
+#pragma once
+
+#include "_cgControl.hpp"
+#include "window.hpp"
+#include "resourceQueue.hpp"
+
+namespace CG {
+    enum class FramePacing {
+        VSync,     // Swap interval 1 on the first main thread window and on every render thread window, so serialized windows don't wait for a vblank each
+        TargetFps, // Sleeps until the next frame is due
+        Adaptive,  // Like TargetFps, but sleeps short by the OS's measured oversleep and yields the rest, for steadier frame times
+        Unlimited
+    };
+
+
+    // Main loop over every window: events are polled once per iteration, the simulation runs in fixed steps and rendering gets the leftover as an interpolation factor.
+    // Windows with a render thread render in parallel with the rest, and the frame ends once all of them are done, so the simulation never races rendering.
+    class Application {
+        private:
+            using Clock = std::chrono::steady_clock;
+
+            std::function<void(float64_t)> onFixedUpdate = [](float64_t){};
+            float64_t fixedTimestep = defaultFixedTimestep;
+            size_t maxFixedStepsPerFrame = defaultMaxFixedStepsPerFrame;
+            FramePacing framePacing = FramePacing::VSync;
+            float64_t targetFps = defaultTargetFps;
+            float64_t idleFps = defaultIdleFps;
+
+            Clock::time_point previousFrameStart;
+            bool started = false;
+            bool quitRequested = false;
+            float64_t accumulator = 0.0;
+            float64_t interpolation = 0.0;
+            float64_t frameTime = 0.0;
+            float64_t sleepOvershoot = 0.0; // Running estimate, in seconds
+            uint64_t frameCount = 0;
+
+            std::unique_ptr<ResourceQueue> resourceQueue = nullptr;
+
+            void applySwapIntervals();
+            bool isIdle() const;
+            void pace(Clock::time_point frameStart);
+
+        public:
+            static constexpr float64_t defaultFixedTimestep = (1.0 / 60.0);
+            static constexpr size_t defaultMaxFixedStepsPerFrame = 8; // Past this the simulation slows down instead of spiralling
+            static constexpr float64_t defaultTargetFps = 60.0;
+            static constexpr float64_t defaultIdleFps = 10.0;          // While every window is minimized, whatever the pacing
+            static constexpr float64_t maxFrameTime = 0.25;             // Longer frames (breakpoints, window drags) count as this
+
+            Application() = default;
+            Application(const Application &) = delete;
+
+            void run();      // Until every window is closed or 'quit' is called
+            void runFrame(); // One iteration, for callers that keep their own loop
+            void quit() noexcept;
+
+            ResourceQueue &getResourceQueue(); // Created on first use, needs a window. Executed every frame before rendering.
+
+            const std::function<void(float64_t)> &getOnFixedUpdate() const;
+            void setOnFixedUpdate(const std::function<void(float64_t)> &value); // Called with the timestep, before rendering
+
+            float64_t getFixedTimestep() const noexcept;
+            void setFixedTimestep(float64_t value);
+            size_t getMaxFixedStepsPerFrame() const noexcept;
+            void setMaxFixedStepsPerFrame(size_t value);
+            FramePacing getFramePacing() const noexcept;
+            void setFramePacing(FramePacing value);
+            float64_t getTargetFps() const noexcept;
+            void setTargetFps(float64_t value);
+            float64_t getIdleFps() const noexcept;
+            void setIdleFps(float64_t value);
+
+            float64_t getInterpolation() const noexcept; // [0, 1), how far rendering is between the last fixed step and the next
+            float64_t getFrameTime() const noexcept;     // Seconds between the last two frame starts
+            uint64_t getFrameCount() const noexcept;
+
+            Application &operator=(const Application &) = delete;
+    };
+}
\ No newline at end of file
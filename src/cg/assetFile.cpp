@@ -0,0 +1,279 @@
+#include "assetFile.hpp"
+
+#if defined(_WIN32)
+    #undef APIENTRY // Redefined by windows.h, nothing here uses GL
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+namespace CG {
+    std::vector<AssetFile::Archive> AssetFile::archives = {};
+    std::mutex AssetFile::archivesMutex;
+
+    std::string AssetFile::getArchiveKey(const std::filesystem::path &path) {
+        const std::filesystem::path relative = path.is_absolute()? path.lexically_relative(std::filesystem::current_path()):path;
+        return relative.lexically_normal().generic_string();
+    }
+
+    const AssetFile::Archive *AssetFile::findArchive(const std::string &key) {
+        const auto archive = std::find_if(archives.rbegin(), archives.rend(), [&](const Archive &archive) {return archive.entries.contains(key);});
+        return (archive == archives.rend())? nullptr:&(*archive);
+    }
+
+    void AssetFile::map(const std::filesystem::path &path) {
+        const auto fail = [&]() {
+            throw std::runtime_error("Failed to open \"" + path.string() + "\":\n" + std::to_string(std::stacktrace::current()));
+        };
+
+        #if defined(_WIN32)
+            const HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, (FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE), nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (file == INVALID_HANDLE_VALUE) fail();
+
+            LARGE_INTEGER size;
+            if (!GetFileSizeEx(file, &size)) {
+                CloseHandle(file);
+                fail();
+            }
+
+            if (size.QuadPart == 0) { // Can't map an empty file
+                CloseHandle(file);
+                return;
+            }
+
+            // The view keeps the mapping and the file open on its own
+            const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            CloseHandle(file);
+            if (mapping == nullptr) fail();
+
+            const void *const data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+            if (data == nullptr) fail();
+
+            bytes = std::span(static_cast<const std::byte *>(data), static_cast<size_t>(size.QuadPart));
+        #else
+            const int file = open(path.c_str(), (O_RDONLY | O_CLOEXEC));
+            if (file < 0) fail();
+
+            struct stat status;
+            if (fstat(file, &status) != 0) {
+                close(file);
+                fail();
+            }
+
+            if (status.st_size == 0) { // Can't map an empty file
+                close(file);
+                return;
+            }
+
+            void *const data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+            close(file);
+            if (data == MAP_FAILED) fail();
+
+            madvise(data, static_cast<size_t>(status.st_size), MADV_WILLNEED); // Loaders read everything, front to back
+            bytes = std::span(static_cast<const std::byte *>(data), static_cast<size_t>(status.st_size));
+        #endif
+
+        mapped = true;
+    }
+
+    void AssetFile::clearFields() noexcept {
+        bytes = {};
+        mapped = false;
+        archive.reset();
+    }
+
+    void AssetFile::moveFrom(AssetFile &other) noexcept {
+        if (this == &other) return;
+
+        bytes = other.bytes;
+        mapped = other.mapped;
+        archive = std::move(other.archive);
+
+        other.clearFields();
+    }
+
+    void AssetFile::destroy() noexcept {
+        if (mapped) {
+            #if defined(_WIN32)
+                UnmapViewOfFile(bytes.data());
+            #else
+                munmap(const_cast<std::byte *>(bytes.data()), bytes.size());
+            #endif
+        }
+        clearFields();
+    }
+
+    void AssetFile::writeArchive(const std::filesystem::path &output, const std::filesystem::path &directory) {
+        std::vector<std::filesystem::path> files;
+        for (const auto &entry: std::filesystem::recursive_directory_iterator(directory)) {
+            if (entry.is_regular_file()) files.push_back(entry.path());
+        }
+        std::sort(files.begin(), files.end());
+
+        std::vector<std::string> keys;
+        size_t tableSize = (archiveMagic.size() + sizeof(uint32_t) + sizeof(uint64_t));
+        for (const auto &file: files) {
+            keys.push_back(getArchiveKey(std::filesystem::absolute(file)));
+            tableSize += ((2 * sizeof(uint64_t)) + sizeof(uint32_t) + keys.back().size());
+        }
+
+        std::ofstream stream(output, std::ios::binary);
+        if (!stream) throw std::runtime_error("Failed to open \"" + output.string() + "\":\n" + std::to_string(std::stacktrace::current()));
+
+        const auto write = [&](const auto &value) {stream.write(reinterpret_cast<const char *>(&value), sizeof(value));};
+
+        stream.write(archiveMagic.data(), archiveMagic.size());
+        write(archiveVersion);
+        write(static_cast<uint64_t>(files.size()));
+
+        uint64_t offset = tableSize;
+        for (size_t i = 0; i < files.size(); ++i) {
+            const uint64_t size = std::filesystem::file_size(files[i]);
+            write(offset);
+            write(size);
+            write(static_cast<uint32_t>(keys[i].size()));
+            stream.write(keys[i].data(), keys[i].size());
+            offset += size;
+        }
+
+        for (const auto &file: files) {
+            const AssetFile asset(file);
+            stream.write(reinterpret_cast<const char *>(asset.getBytes().data()), asset.getSize());
+        }
+
+        if (!stream) throw std::runtime_error("Failed to write \"" + output.string() + "\":\n" + std::to_string(std::stacktrace::current()));
+    }
+
+    void AssetFile::mountArchive(const std::filesystem::path &path) {
+        Archive archive;
+        archive.path = path;
+        archive.file = std::make_shared<const AssetFile>(path);
+
+        const std::span<const std::byte> data = archive.file->getBytes();
+        size_t position = 0;
+        const auto read = [&]<typename T>(T &value) {
+            if (sizeof(T) > (data.size() - position)) throw std::runtime_error("Archive \"" + path.string() + "\" is truncated:\n" + std::to_string(std::stacktrace::current()));
+            std::memcpy(&value, (data.data() + position), sizeof(T));
+            position += sizeof(T);
+        };
+
+        std::array<char, 4> magic;
+        uint32_t version;
+        uint64_t entryCount;
+        read(magic);
+        read(version);
+        read(entryCount);
+        if ((magic != archiveMagic) || (version != archiveVersion)) {
+            throw std::runtime_error("\"" + path.string() + "\" isn't a version " + std::to_string(archiveVersion) + " asset archive:\n" + std::to_string(std::stacktrace::current()));
+        }
+
+        for (uint64_t i = 0; i < entryCount; ++i) {
+            uint64_t offset, size;
+            uint32_t keyLength;
+            read(offset);
+            read(size);
+            read(keyLength);
+
+            // Subtracting rather than adding, a corrupt offset or size near 2^64 would wrap the sum back in bounds
+            if ((keyLength > (data.size() - position)) || (offset > data.size()) || (size > (data.size() - offset))) {
+                throw std::runtime_error("Archive \"" + path.string() + "\" is truncated:\n" + std::to_string(std::stacktrace::current()));
+            }
+
+            std::string key(reinterpret_cast<const char *>(data.data() + position), keyLength);
+            position += keyLength;
+            archive.entries.emplace(std::move(key), data.subspan(offset, size));
+        }
+
+        const std::lock_guard lock(archivesMutex);
+        archives.push_back(std::move(archive));
+    }
+
+    void AssetFile::unmountArchives() {
+        const std::lock_guard lock(archivesMutex);
+        archives.clear(); // Open views keep their archive mapped
+    }
+
+    bool AssetFile::exists(const std::filesystem::path &path) {
+        {
+            const std::lock_guard lock(archivesMutex);
+            if (findArchive(getArchiveKey(path)) != nullptr) return true;
+        }
+
+        std::error_code error;
+        return std::filesystem::is_regular_file(path, error);
+    }
+
+    std::optional<std::filesystem::file_time_type> AssetFile::getModifiedTime(const std::filesystem::path &path) {
+        std::filesystem::path source = path;
+        {
+            const std::lock_guard lock(archivesMutex);
+            if (const Archive *const archive = findArchive(getArchiveKey(path))) source = archive->path;
+        }
+
+        std::error_code error;
+        const std::filesystem::file_time_type result = std::filesystem::last_write_time(source, error);
+        if (error) return std::nullopt;
+        return result;
+    }
+
+    void AssetFile::prefetch(const std::filesystem::path &path) {
+        {
+            const std::lock_guard lock(archivesMutex);
+            if (findArchive(getArchiveKey(path)) != nullptr) return; // Mapped already, with read ahead advised
+        }
+
+        #if defined(_WIN32)
+            #if (_WIN32_WINNT >= 0x0602)
+                // Issues the reads and returns, the pages stay cached after unmapping
+                try {
+                    const AssetFile file(path);
+                    WIN32_MEMORY_RANGE_ENTRY range = {const_cast<std::byte *>(file.getBytes().data()), file.getSize()};
+                    if (range.NumberOfBytes != 0) PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+                }
+                catch (const std::runtime_error &) {} // Only a hint, opening it for real reports the error
+            #endif
+        #else
+            const int file = open(path.c_str(), (O_RDONLY | O_CLOEXEC));
+            if (file < 0) return;
+
+            posix_fadvise(file, 0, 0, POSIX_FADV_WILLNEED); // Starts read ahead without waiting for it
+            close(file);
+        #endif
+    }
+
+    AssetFile::AssetFile(const std::filesystem::path &path) {
+        {
+            const std::lock_guard lock(archivesMutex);
+            const std::string key = getArchiveKey(path);
+            if (const Archive *const found = findArchive(key)) {
+                bytes = found->entries.at(key);
+                archive = found->file;
+                return;
+            }
+        }
+
+        map(path);
+    }
+
+    AssetFile::AssetFile(AssetFile &&other) noexcept {this->moveFrom(other);}
+
+    std::span<const std::byte> AssetFile::getBytes() const noexcept {return bytes;}
+    std::string_view AssetFile::getText() const noexcept {return std::string_view(reinterpret_cast<const char *>(bytes.data()), bytes.size());}
+    size_t AssetFile::getSize() const noexcept {return bytes.size();}
+
+    AssetFile &AssetFile::operator=(AssetFile &&other) noexcept {
+        if (this != &other) {
+            destroy();
+            this->moveFrom(other);
+        }
+        return (*this);
+    }
+
+    AssetFile::~AssetFile() noexcept {destroy();}
+}
\ No newline at end of file
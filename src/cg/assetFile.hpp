@@ -0,0 +1,60 @@
+#pragma once
+
+#include <mutex>
+#include "_cgControl.hpp"
+
+namespace CG {
+    // Read-only view of a whole asset, memory-mapped rather than copied. Move only.
+    // Comes from the most recently mounted archive that has the path, otherwise from the file itself.
+    class AssetFile {
+        private:
+            struct Archive {
+                std::filesystem::path path = "";
+                std::shared_ptr<const AssetFile> file;
+                std::unordered_map<std::string, std::span<const std::byte>> entries; // Keyed like 'getArchiveKey'
+            };
+
+            static constexpr std::array<char, 4> archiveMagic = {'C', 'G', 'P', 'K'};
+            static constexpr uint32_t archiveVersion = 1;
+
+            static std::vector<Archive> archives;
+            static std::mutex archivesMutex;
+
+            std::span<const std::byte> bytes;
+            bool mapped = false;                       // Owns the mapping of 'bytes', otherwise it points into 'archive'
+            std::shared_ptr<const AssetFile> archive;  // Keeps the archive mapped while the view lives
+
+            static std::string getArchiveKey(const std::filesystem::path &path);
+            static const Archive *findArchive(const std::string &key); // Locked by the caller
+
+            void map(const std::filesystem::path &path);
+            void clearFields() noexcept;
+            void moveFrom(AssetFile &other) noexcept;
+            void destroy() noexcept;
+
+        public:
+            // Archive layout, native endianness: magic, uint32 version, uint64 entry count,
+            // then per entry uint64 offset, uint64 size, uint32 path length and the path, then the data
+            static void writeArchive(const std::filesystem::path &output, const std::filesystem::path &directory); // Every file under 'directory', keyed by its path relative to the working directory
+            static void mountArchive(const std::filesystem::path &path); // Its entries shadow loose files and earlier archives
+            static void unmountArchives();
+
+            static bool exists(const std::filesystem::path &path);
+            static std::optional<std::filesystem::file_time_type> getModifiedTime(const std::filesystem::path &path); // The archive's, for archived assets
+            static void prefetch(const std::filesystem::path &path); // Lets the OS start reading the file in the background, so a later open doesn't wait on the disk
+
+            AssetFile() = delete;
+            explicit AssetFile(const std::filesystem::path &path);
+            AssetFile(const AssetFile &) = delete;
+            AssetFile(AssetFile &&other) noexcept;
+
+            std::span<const std::byte> getBytes() const noexcept;
+            std::string_view getText() const noexcept;
+            size_t getSize() const noexcept;
+
+            AssetFile &operator=(const AssetFile &) = delete;
+            AssetFile &operator=(AssetFile &&other) noexcept;
+
+            ~AssetFile() noexcept;
+    };
+}
\ No newline at end of file
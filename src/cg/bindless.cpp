@@ -0,0 +1,164 @@
+#include "bindless.hpp"
+
+namespace CG {
+    const std::optional<BindlessApi> &BindlessApi::get() {
+        static const std::optional<BindlessApi> api = []() -> std::optional<BindlessApi> {
+            if (glfwExtensionSupported("GL_ARB_bindless_texture") != GLFW_TRUE) return std::nullopt;
+
+            BindlessApi result;
+            result.getTextureSamplerHandle = std::bit_cast<GetTextureSamplerHandleProc>(glfwGetProcAddress("glGetTextureSamplerHandleARB"));
+            result.makeTextureHandleResident = std::bit_cast<MakeTextureHandleResidentProc>(glfwGetProcAddress("glMakeTextureHandleResidentARB"));
+            result.makeTextureHandleNonResident = std::bit_cast<MakeTextureHandleNonResidentProc>(glfwGetProcAddress("glMakeTextureHandleNonResidentARB"));
+
+            if (!(result.getTextureSamplerHandle && result.makeTextureHandleResident && result.makeTextureHandleNonResident)) return std::nullopt;
+            return result;
+        }();
+
+        return api;
+    }
+
+
+    uint64_t BindlessResidency::makeKey(uint32_t textureId, uint32_t samplerId) noexcept {
+        return ((static_cast<uint64_t>(textureId) << 32) | samplerId);
+    }
+
+    void BindlessResidency::makeResident(uint64_t key, Entry &entry) {
+        evictToFit(entry.byteSize);
+
+        api.makeTextureHandleResident(entry.handle);
+        entry.resident = true;
+        residentBytes += entry.byteSize;
+
+        leastRecentlyUsed.push_front(key);
+        lruPositions[key] = leastRecentlyUsed.begin();
+    }
+
+    void BindlessResidency::makeNonResident(uint64_t key, Entry &entry) {
+        api.makeTextureHandleNonResident(entry.handle);
+        entry.resident = false;
+        residentBytes -= entry.byteSize;
+
+        const auto position = lruPositions.find(key);
+        leastRecentlyUsed.erase(position->second);
+        lruPositions.erase(position);
+    }
+
+    void BindlessResidency::evictToFit(size_t incomingBytes) {
+        // Whatever was used this frame may still be referenced by queued draws, so it stays even if that means going over budget
+        while (((residentBytes + incomingBytes) > budget) && !leastRecentlyUsed.empty()) {
+            const uint64_t victimKey = leastRecentlyUsed.back();
+            Entry &victim = entries[victimKey];
+            if (victim.lastUsedFrame == frame) break;
+
+            makeNonResident(victimKey, victim);
+            ++evictionCount;
+        }
+    }
+
+    void BindlessResidency::releasePending() noexcept {
+        if (!hasPendingReleases.load(std::memory_order_acquire)) return;
+
+        const std::lock_guard lock(pendingMutex);
+        for (const uint32_t textureId: pendingReleases) release(textureId);
+        pendingReleases.clear();
+        hasPendingReleases.store(false, std::memory_order_relaxed);
+    }
+
+    BindlessResidency::BindlessResidency(const BindlessApi &api, size_t budget): api(api), budget(budget) {}
+
+    GLuint64 BindlessResidency::acquire(uint32_t textureId, uint32_t samplerId, size_t byteSize) {
+        releasePending(); // Before a recycled texture id could match a deleted texture's entry
+
+        const uint64_t key = makeKey(textureId, samplerId);
+        auto [iter, inserted] = entries.try_emplace(key);
+        Entry &entry = iter->second;
+
+        if (inserted) {
+            entry.textureId = textureId;
+            entry.handle = api.getTextureSamplerHandle(textureId, samplerId);
+            entry.byteSize = byteSize;
+        }
+
+        entry.lastUsedFrame = frame;
+        if (!entry.resident) makeResident(key, entry);
+        else leastRecentlyUsed.splice(leastRecentlyUsed.begin(), leastRecentlyUsed, lruPositions[key]);
+
+        return entry.handle;
+    }
+
+    void BindlessResidency::release(uint32_t textureId) noexcept {
+        // Every sampler the texture was paired with
+        for (auto iter = entries.begin(); iter != entries.end();) {
+            if (iter->second.textureId != textureId) {
+                ++iter;
+                continue;
+            }
+
+            if (iter->second.resident) makeNonResident(iter->first, iter->second);
+            iter = entries.erase(iter);
+        }
+    }
+
+    void BindlessResidency::queueRelease(uint32_t textureId) {
+        const std::lock_guard lock(pendingMutex);
+        pendingReleases.push_back(textureId);
+        hasPendingReleases.store(true, std::memory_order_release);
+    }
+
+    void BindlessResidency::beginFrame() noexcept {
+        releasePending();
+        ++frame;
+        evictToFit(0);
+    }
+
+    size_t BindlessResidency::getBudget() const noexcept {return budget;}
+
+    void BindlessResidency::setBudget(size_t value) {
+        budget = value;
+        evictToFit(0);
+    }
+
+    size_t BindlessResidency::getResidentBytes() const noexcept {return residentBytes;}
+    size_t BindlessResidency::getResidentCount() const noexcept {return leastRecentlyUsed.size();}
+    size_t BindlessResidency::getEvictionCount() const noexcept {return evictionCount;}
+
+    bool BindlessResidency::isResident(uint32_t textureId, uint32_t samplerId) const noexcept {
+        const auto iter = entries.find(makeKey(textureId, samplerId));
+        return ((iter != entries.end()) && iter->second.resident);
+    }
+
+
+    BindlessMaterialTable::BindlessMaterialTable() {
+        glCreateBuffers(1, &bufferId);
+    }
+
+    void BindlessMaterialTable::set(size_t materialId, GLuint64 handle) {
+        if (materialId >= handles.size()) handles.resize((materialId + 1), 0);
+        if (handles[materialId] == handle) return;
+
+        handles[materialId] = handle;
+        dirty = true;
+    }
+
+    size_t BindlessMaterialTable::getCount() const noexcept {return handles.size();}
+
+    void BindlessMaterialTable::bind(uint32_t bindingPoint) {
+        if (dirty) {
+            const size_t byteSize = (handles.size() * sizeof(GLuint64));
+
+            if (byteSize > bufferCapacity) {
+                glNamedBufferData(bufferId, byteSize, handles.data(), static_cast<GLenum>(DrawMode::Dynamic));
+                bufferCapacity = byteSize;
+            }
+            else glNamedBufferSubData(bufferId, 0, byteSize, handles.data());
+
+            dirty = false;
+        }
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, bindingPoint, bufferId);
+    }
+
+    BindlessMaterialTable::~BindlessMaterialTable() noexcept {
+        glDeleteBuffers(1, &bufferId);
+    }
+}
\ No newline at end of file
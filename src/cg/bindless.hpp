@@ -0,0 +1,99 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include "_cgControl.hpp"
+#include "drawMode.hpp"
+
+namespace CG {
+    // GL_ARB_bindless_texture entry points. Glad is generated without extensions, so they're loaded by hand. Tests can fill one with stubs.
+    struct BindlessApi {
+        using GetTextureSamplerHandleProc = GLuint64 (APIENTRYP)(GLuint texture, GLuint sampler);
+        using MakeTextureHandleResidentProc = void (APIENTRYP)(GLuint64 handle);
+        using MakeTextureHandleNonResidentProc = void (APIENTRYP)(GLuint64 handle);
+
+        GetTextureSamplerHandleProc getTextureSamplerHandle = nullptr;
+        MakeTextureHandleResidentProc makeTextureHandleResident = nullptr;
+        MakeTextureHandleNonResidentProc makeTextureHandleNonResident = nullptr;
+
+        static const std::optional<BindlessApi> &get(); // Loaded once, needs a current context. Empty when the extension is missing.
+    };
+
+
+    // Keeps texture handles resident in one context within a byte budget, evicting the least recently used ones that weren't used this frame.
+    // Residency is per context and goes away with it, handles are shared by every context that shares the texture.
+    // Only the thread the context is current on touches it, other threads go through 'queueRelease'.
+    class BindlessResidency {
+        private:
+            struct Entry {
+                uint32_t textureId = 0;
+                GLuint64 handle = 0;
+                size_t byteSize = 0;
+                uint64_t lastUsedFrame = 0;
+                bool resident = false;
+            };
+
+            BindlessApi api;
+            size_t budget = 0;
+            size_t residentBytes = 0;
+            uint64_t frame = 0;
+            size_t evictionCount = 0;
+            std::unordered_map<uint64_t, Entry> entries; // By 'makeKey'
+            std::list<uint64_t> leastRecentlyUsed;      // Resident keys, most recently used at the front
+            std::unordered_map<uint64_t, std::list<uint64_t>::iterator> lruPositions;
+            std::mutex pendingMutex;
+            std::vector<uint32_t> pendingReleases; // Texture ids deleted while another context was current
+            std::atomic<bool> hasPendingReleases = false;
+
+            static uint64_t makeKey(uint32_t textureId, uint32_t samplerId) noexcept;
+
+            void makeResident(uint64_t key, Entry &entry);
+            void makeNonResident(uint64_t key, Entry &entry);
+            void evictToFit(size_t incomingBytes);
+            void releasePending() noexcept;
+
+        public:
+            static constexpr size_t defaultBudget = (static_cast<size_t>(512) << 20);
+
+            BindlessResidency(const BindlessApi &api, size_t budget = defaultBudget);
+            BindlessResidency(const BindlessResidency &) = delete;
+
+            GLuint64 acquire(uint32_t textureId, uint32_t samplerId, size_t byteSize); // Makes the handle resident and marks it used this frame
+            void release(uint32_t textureId) noexcept;                                 // Call before the texture is deleted, with this context current
+            void queueRelease(uint32_t textureId);                                     // Any thread, released by the next 'beginFrame' or 'acquire'
+            void beginFrame() noexcept;
+
+            size_t getBudget() const noexcept;
+            void setBudget(size_t value);
+            size_t getResidentBytes() const noexcept;
+            size_t getResidentCount() const noexcept;
+            size_t getEvictionCount() const noexcept;
+            bool isResident(uint32_t textureId, uint32_t samplerId) const noexcept;
+
+            BindlessResidency &operator=(const BindlessResidency &) = delete;
+    };
+
+
+    // Handles indexed by material id, in a shader storage buffer. In GLSL:
+    //     layout(std430, binding = N) readonly buffer Materials {uvec2 materialTextures[];};
+    //     texture(sampler2D(materialTextures[materialId]), uv)
+    class BindlessMaterialTable {
+        private:
+            uint32_t bufferId = 0;
+            size_t bufferCapacity = 0;
+            std::vector<GLuint64> handles;
+            bool dirty = false;
+
+        public:
+            BindlessMaterialTable();
+            BindlessMaterialTable(const BindlessMaterialTable &) = delete;
+
+            void set(size_t materialId, GLuint64 handle);
+            size_t getCount() const noexcept;
+            void bind(uint32_t bindingPoint); // Uploads pending changes first
+
+            BindlessMaterialTable &operator=(const BindlessMaterialTable &) = delete;
+
+            ~BindlessMaterialTable() noexcept;
+    };
+}
\ No newline at end of file
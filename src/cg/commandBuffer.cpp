@@ -0,0 +1,116 @@
+#include "commandBuffer.hpp"
+#include "profiler.hpp"
+
+namespace CG {
+    namespace {
+        template<typename ...Functions>
+        struct Overload: Functions... {
+            using Functions::operator()...;
+        };
+    }
+
+    size_t CommandBuffer::getIndexSize(GLenum indexType) noexcept {
+        switch (indexType) {
+            case GL_UNSIGNED_BYTE: return sizeof(uint8_t);
+            case GL_UNSIGNED_SHORT: return sizeof(uint16_t);
+            default: return sizeof(uint32_t);
+        }
+    }
+
+    CommandBuffer::CommandBuffer(size_t reservedBytes) {
+        bytes.reserve(reservedBytes);
+    }
+
+    void CommandBuffer::bindShader(Shader &shader) {
+        if (recordedShader == &shader) return;
+
+        recordedShader = &shader;
+        push(RenderCommands::BindShader{&shader});
+    }
+
+    void CommandBuffer::bindTexture(Shader &shader, UniformHandle handle, const Texture &texture) {
+        if (!handle.isValid()) return;
+        push(RenderCommands::BindTexture{&shader, handle, &texture});
+    }
+
+    void CommandBuffer::bindMesh(const Mesh &mesh) {
+        if (recordedMesh == &mesh) return;
+
+        recordedMesh = &mesh;
+        push(RenderCommands::BindMesh{&mesh});
+    }
+
+    void CommandBuffer::drawElements(uint32_t count, uint32_t firstIndex, GLenum indexType) {
+        ASSERT(recordedShader != nullptr);
+        push(RenderCommands::DrawElements{count, firstIndex, indexType});
+    }
+
+    void CommandBuffer::drawElementsInstanced(uint32_t count, uint32_t firstIndex, GLenum indexType, uint32_t instanceCount) {
+        ASSERT(recordedShader != nullptr);
+        push(RenderCommands::DrawElementsInstanced{count, firstIndex, indexType, instanceCount});
+    }
+
+    void CommandBuffer::drawMesh(const Mesh &mesh) {
+        bindMesh(mesh);
+        drawElements(mesh.getIndexCount(), 0, mesh.getIndexType());
+    }
+
+    void CommandBuffer::append(const CommandBuffer &other) {
+        bytes.insert(bytes.end(), other.bytes.begin(), other.bytes.end());
+        commandCount += other.commandCount;
+
+        // Replay leaves the other buffer's last binds in place, or ours if it bound nothing
+        if (other.recordedShader != nullptr) recordedShader = other.recordedShader;
+        if (other.recordedMesh != nullptr) recordedMesh = other.recordedMesh;
+    }
+
+    void CommandBuffer::clear() noexcept {
+        bytes.clear();
+        commandCount = 0;
+        recordedShader = nullptr;
+        recordedMesh = nullptr;
+    }
+
+    size_t CommandBuffer::getCommandCount() const noexcept {return commandCount;}
+    size_t CommandBuffer::getByteSize() const noexcept {return bytes.size();}
+    bool CommandBuffer::isEmpty() const noexcept {return (commandCount == 0);}
+
+    void CommandBuffer::execute() const {
+        CG_PROFILE_ZONE("CommandBuffer::execute");
+
+        Shader *shader = nullptr;
+        bool shaderBound = false; // Bound lazily at the next draw, so uniforms set in between are flushed with it
+
+        const auto prepareDraw = [&]() {
+            if (!shaderBound) {
+                shader->bind();
+                shaderBound = true;
+            }
+            else shader->flushUniforms();
+        };
+
+        visit(Overload{
+            [&](const RenderCommands::BindShader &command) {
+                shader = command.shader;
+                shaderBound = false;
+            },
+            [&](const RenderCommands::SetUniform &command, std::span<const std::byte> value) {
+                command.shader->stageUniform(command.handle, value.data(), value.size(), command.count, command.upload);
+            },
+            [&](const RenderCommands::BindTexture &command) {
+                command.shader->setUniform<int32_t>(command.handle, command.texture->bind());
+            },
+            [&](const RenderCommands::BindMesh &command) {
+                command.mesh->bind();
+            },
+            [&](const RenderCommands::DrawElements &command) {
+                prepareDraw();
+                glDrawElements(GL_TRIANGLES, command.count, command.indexType, std::bit_cast<const void *>(command.firstIndex * getIndexSize(command.indexType)));
+            },
+            [&](const RenderCommands::DrawElementsInstanced &command) {
+                prepareDraw();
+                glDrawElementsInstanced(GL_TRIANGLES, command.count, command.indexType, std::bit_cast<const void *>(command.firstIndex * getIndexSize(command.indexType)), command.instanceCount);
+            }
+        });
+    }
+}
\ No newline at end of file
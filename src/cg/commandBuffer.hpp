@@ -0,0 +1,170 @@
+#pragma once
+
+#include "_cgControl.hpp"
+#include "shader.hpp"
+#include "texture.hpp"
+#include "mesh.hpp"
+
+namespace CG {
+    enum class RenderCommandType: uint32_t {BindShader, SetUniform, BindTexture, BindMesh, DrawElements, DrawElementsInstanced};
+
+    // Commands as stored in a 'CommandBuffer', each one preceded by a 'RenderCommandHeader'. Recording only copies these, it never touches GL.
+    namespace RenderCommands {
+        struct BindShader {
+            static constexpr RenderCommandType type = RenderCommandType::BindShader;
+            Shader *shader = nullptr;
+        };
+
+        // The value's bytes follow the command, staged into the shader when replayed
+        struct SetUniform {
+            static constexpr RenderCommandType type = RenderCommandType::SetUniform;
+            Shader *shader = nullptr;
+            UniformHandle handle;
+            int32_t count = 1;
+            uint32_t size = 0;
+            UniformUploadFunction upload = nullptr;
+        };
+
+        // Sets the texture's unit to a sampler uniform
+        struct BindTexture {
+            static constexpr RenderCommandType type = RenderCommandType::BindTexture;
+            Shader *shader = nullptr;
+            UniformHandle handle;
+            const Texture *texture = nullptr;
+        };
+
+        // Vertex and index buffers, every window has a single vertex array
+        struct BindMesh {
+            static constexpr RenderCommandType type = RenderCommandType::BindMesh;
+            const Mesh *mesh = nullptr;
+        };
+
+        struct DrawElements {
+            static constexpr RenderCommandType type = RenderCommandType::DrawElements;
+            uint32_t count = 0;
+            uint32_t firstIndex = 0;
+            GLenum indexType = GL_UNSIGNED_INT;
+        };
+
+        struct DrawElementsInstanced {
+            static constexpr RenderCommandType type = RenderCommandType::DrawElementsInstanced;
+            uint32_t count = 0;
+            uint32_t firstIndex = 0;
+            GLenum indexType = GL_UNSIGNED_INT;
+            uint32_t instanceCount = 0;
+        };
+    }
+
+    template<typename T>
+    concept renderCommandType = std::is_trivially_copyable_v<T> && requires() {{auto(T::type)} -> std::same_as<RenderCommandType>;};
+
+    struct RenderCommandHeader {
+        RenderCommandType type = RenderCommandType::BindShader;
+        uint32_t size = 0; // Of the whole record, header included and padded to 'CommandBuffer::alignment'
+    };
+
+
+    // Compact stream of typed commands, recorded on any thread and replayed by 'execute' on the context's thread.
+    // One buffer per recording thread, merged in a fixed order with 'append'. Redundant shader and mesh binds are dropped while recording.
+    // Everything referred to must outlive the replay.
+    class CommandBuffer {
+        private:
+            std::vector<std::byte> bytes; // Kept across 'clear', so a buffer reused every frame stops allocating
+            size_t commandCount = 0;
+            const Shader *recordedShader = nullptr; // Last bound while recording
+            const Mesh *recordedMesh = nullptr;
+
+            template<renderCommandType T> std::byte *push(const T &command, size_t payloadSize = 0);
+            static size_t getIndexSize(GLenum indexType) noexcept;
+
+        public:
+            static constexpr size_t alignment = alignof(std::max_align_t);
+
+            CommandBuffer() = default;
+            explicit CommandBuffer(size_t reservedBytes);
+
+            void bindShader(Shader &shader);
+            template<typename T> void setUniform(Shader &shader, UniformHandle handle, const T &value) requires (!(std::is_pointer_v<T>) && !(std::is_array_v<T>));
+            template<typename T> void setUniform(Shader &shader, UniformHandle handle, std::span<const T> values);
+            void bindTexture(Shader &shader, UniformHandle handle, const Texture &texture);
+            void bindMesh(const Mesh &mesh);
+            void drawElements(uint32_t count, uint32_t firstIndex, GLenum indexType);
+            void drawElementsInstanced(uint32_t count, uint32_t firstIndex, GLenum indexType, uint32_t instanceCount);
+            void drawMesh(const Mesh &mesh); // Binds it first if needed
+            void append(const CommandBuffer &other);
+            void clear() noexcept;
+
+            size_t getCommandCount() const noexcept;
+            size_t getByteSize() const noexcept;
+            bool isEmpty() const noexcept;
+
+            // Calls 'visitor(command)' for each command in order, 'visitor(command, valueBytes)' for 'SetUniform'. No GL needed.
+            template<typename Visitor> void visit(Visitor &&visitor) const;
+
+            void execute() const; // On the thread with the target context current
+    };
+
+
+    template<renderCommandType T>
+    std::byte *CommandBuffer::push(const T &command, size_t payloadSize) {
+        static_assert((sizeof(RenderCommandHeader) % alignof(T)) == 0);
+
+        const size_t unpaddedSize = (sizeof(RenderCommandHeader) + sizeof(T) + payloadSize);
+        const size_t size = (((unpaddedSize + alignment - 1) / alignment) * alignment);
+        const size_t offset = bytes.size();
+        bytes.resize(offset + size);
+
+        const RenderCommandHeader header = {T::type, static_cast<uint32_t>(size)};
+        std::memcpy(&bytes[offset], &header, sizeof(header));
+        std::memcpy(&bytes[offset + sizeof(header)], &command, sizeof(T));
+
+        ++commandCount;
+        return (bytes.data() + offset + sizeof(header) + sizeof(T)); // Past the end when there's no payload nor padding, so not through 'operator[]'
+    }
+
+    template<typename T>
+    void CommandBuffer::setUniform(Shader &shader, UniformHandle handle, const T &value) requires (!(std::is_pointer_v<T>) && !(std::is_array_v<T>)) {
+        if (!handle.isValid()) return;
+
+        const RenderCommands::SetUniform command = {&shader, handle, 1, sizeof(T), &uploadUniform<T>};
+        std::memcpy(push(command, sizeof(T)), &value, sizeof(T));
+    }
+
+    template<typename T>
+    void CommandBuffer::setUniform(Shader &shader, UniformHandle handle, std::span<const T> values) {
+        if (!handle.isValid()) return;
+
+        const RenderCommands::SetUniform command = {&shader, handle, static_cast<int32_t>(values.size()), static_cast<uint32_t>(values.size_bytes()), &uploadUniform<T>};
+        std::memcpy(push(command, values.size_bytes()), values.data(), values.size_bytes());
+    }
+
+    template<typename Visitor>
+    void CommandBuffer::visit(Visitor &&visitor) const {
+        const auto read = [&]<renderCommandType T>(size_t offset) {
+            T command;
+            std::memcpy(&command, &bytes[offset + sizeof(RenderCommandHeader)], sizeof(T));
+            return command;
+        };
+
+        for (size_t offset = 0; offset < bytes.size();) {
+            RenderCommandHeader header;
+            std::memcpy(&header, &bytes[offset], sizeof(header));
+
+            switch (header.type) {
+                case RenderCommandType::BindShader: visitor(read.template operator()<RenderCommands::BindShader>(offset)); break;
+                case RenderCommandType::BindTexture: visitor(read.template operator()<RenderCommands::BindTexture>(offset)); break;
+                case RenderCommandType::BindMesh: visitor(read.template operator()<RenderCommands::BindMesh>(offset)); break;
+                case RenderCommandType::DrawElements: visitor(read.template operator()<RenderCommands::DrawElements>(offset)); break;
+                case RenderCommandType::DrawElementsInstanced: visitor(read.template operator()<RenderCommands::DrawElementsInstanced>(offset)); break;
+
+                case RenderCommandType::SetUniform: {
+                    const RenderCommands::SetUniform command = read.template operator()<RenderCommands::SetUniform>(offset);
+                    visitor(command, std::span<const std::byte>((bytes.data() + offset + sizeof(RenderCommandHeader) + sizeof(command)), command.size));
+                    break;
+                }
+            }
+
+            offset += header.size;
+        }
+    }
+}
\ No newline at end of file
@@ -1,7 +1,7 @@
 #include "shader.hpp"
 
 namespace CG {
-    Shader::CompiledShaderStage::CompiledShaderStage(const std::filesystem::path &path) {
+    Shader::CompiledShaderStage::CompiledShaderStage(const std::filesystem::path &path, std::string_view defines) {
         const std::optional<ShaderStage> stageOptional = Shader::getShaderStageFromExtension(path);
         if (!stageOptional.has_value()) {
             this->id = 0;
@@ -10,16 +10,19 @@ namespace CG {
 
         const ShaderStage stage = stageOptional.value();
 
-        std::ifstream file(path);
-        if (!file) throw std::runtime_error("Failed to open \"" + path.string() + "\":\n" + std::to_string(std::stacktrace::current()));
+        const ResolvedShaderSource source = ShaderSources::resolve(path);
+        std::string src = source.text;
 
-        std::string line, src;
-        while (std::getline(file, line)) {
-            src.append(line);
-            src.push_back('\n');
+        if (!defines.empty()) {
+            const size_t version = src.find("#version");
+            const size_t position = (version == std::string::npos)? 0:(src.find('\n', version) + 1);
+            const size_t line = (std::count(src.begin(), (src.begin() + position), '\n') + 1);
+
+            src.insert(position, std::string(defines) + "#line " + std::to_string(line) + '\n'); // Keeps the compiler's line numbers matching the file
         }
 
-        file.close();
+        this->sources = source.files;
+        this->sourceHash = hashFnv1a(src);
 
         this->id = glCreateShader(static_cast<GLenum>(stage));
         const char *const srcPtr = src.c_str();
@@ -38,16 +41,22 @@ namespace CG {
 
             glGetShaderInfoLog(this->id, messageLength, &messageLength, msg.data());
 
-            throw std::runtime_error("Error compiling shader stage \"" + path.string() + "\":" + msg + '\n' + std::to_string(std::stacktrace::current()));
+            // Messages name files by '#line' source string number
+            std::string sourceNames = "";
+            for (size_t i = 0; i < this->sources.size(); ++i) sourceNames += "    " + std::to_string(i) + ": " + this->sources[i].path.string() + '\n';
+
+            throw std::runtime_error("Error compiling shader stage \"" + path.string() + "\":" + msg + "\nSource strings:\n" + sourceNames + std::to_string(std::stacktrace::current()));
         }
     }
 
-    Shader::CompiledShaderStage::CompiledShaderStage(Shader::CompiledShaderStage &&other) noexcept: id(other.id) {
+    Shader::CompiledShaderStage::CompiledShaderStage(Shader::CompiledShaderStage &&other) noexcept: id(other.id), sources(std::move(other.sources)), sourceHash(other.sourceHash) {
         other.id = 0;
     }
 
     Shader::CompiledShaderStage &Shader::CompiledShaderStage::operator=(Shader::CompiledShaderStage &&other) noexcept {
         this->id = other.id;
+        this->sources = std::move(other.sources);
+        this->sourceHash = other.sourceHash;
         other.id = 0;
         return (*this);
     }
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "_cgControl.hpp"
+#include "transformHierarchy.hpp"
+#include "shader.hpp"
+#include "texture.hpp"
+#include "mesh.hpp"
+
+// Components of renderable entities in an 'EntityRegistry'. Plain data, the systems iterating them own the behaviour.
+
+namespace CG {
+    // Node in the scene's 'TransformHierarchy', which owns the local transform and caches the world matrix
+    struct Transform {
+        TransformId node;
+    };
+
+    struct MeshRef {
+        const Mesh *mesh = nullptr;
+    };
+
+    // What a 'RenderItem' needs besides the mesh and transform
+    struct MaterialRef {
+        Shader *shader = nullptr;
+        const Texture *texture = nullptr;
+        UniformHandle textureUniform;
+        UniformHandle transformUniform;
+        uint8_t layer = 0;
+        bool translucent = false;
+    };
+
+    // Bounding sphere in the mesh's local space, for culling
+    struct Bounds {
+        Vector3 center = Vector3::zero;
+        float32_t radius = 0.0f;
+    };
+}
\ No newline at end of file
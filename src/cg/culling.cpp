@@ -0,0 +1,251 @@
+#include "culling.hpp"
+#include "profiler.hpp"
+
+namespace CG {
+    static_assert(sizeof(CullObject) == (sizeof(Instance) + (8 * sizeof(uint32_t))), "CullObject must match the std430 'Object' struct");
+    static_assert((sizeof(CullObject) % 16) == 0);
+
+    Frustum Frustum::fromViewProjection(const Matrix4 &viewProjection) noexcept {
+        // Gribb and Hartmann: each clip plane is the last row plus or minus another one
+        const Vector4 x = viewProjection.getRow(0), y = viewProjection.getRow(1), z = viewProjection.getRow(2), w = viewProjection.getRow(3);
+
+        Frustum result;
+        result.planes = {(w + x), (w - x), (w + y), (w - y), (w + z), (w - z)};
+        for (Vector4 &plane: result.planes) {
+            const float32_t length = Vector3(plane.x, plane.y, plane.z).magnitude();
+            if (length > 0.0f) plane = (plane / length);
+        }
+        return result;
+    }
+
+    bool Frustum::intersects(const Vector3 &center, float32_t radius) const noexcept {
+        for (const Vector4 &plane: planes) {
+            if ((((plane.x * center.x) + (plane.y * center.y) + (plane.z * center.z)) + plane.w) < -radius) return false;
+        }
+        return true;
+    }
+
+
+    Bounds transformBounds(const Bounds &bounds, const Matrix4 &model) noexcept {
+        const Vector4 center = (model * Vector4(bounds.center.x, bounds.center.y, bounds.center.z, 1.0f));
+
+        float32_t maxScaleSquared = 0.0f;
+        for (size_t axis = 0; axis < 3; ++axis) {
+            const Vector4 column = model.getCol(axis);
+            maxScaleSquared = std::max(maxScaleSquared, ((column.x * column.x) + (column.y * column.y) + (column.z * column.z)));
+        }
+
+        Bounds result;
+        result.center = Vector3(center.x, center.y, center.z);
+        result.radius = (bounds.radius * std::sqrt(maxScaleSquared));
+        return result;
+    }
+
+    size_t cullOnCpu(const Frustum &frustum, std::span<const CullObject> objects, std::vector<DrawElementsIndirectCommand> &commands, std::vector<Instance> &draws) {
+        const size_t previousCount = commands.size();
+
+        for (const CullObject &object: objects) {
+            const Bounds world = transformBounds({Vector3(object.bounds.x, object.bounds.y, object.bounds.z), object.bounds.w}, object.instance.model);
+            if (!frustum.intersects(world.center, world.radius)) continue;
+
+            DrawElementsIndirectCommand command;
+            command.count = object.indexCount;
+            command.instanceCount = 1;
+            command.firstIndex = object.firstIndex;
+            command.baseVertex = object.baseVertex;
+            command.baseInstance = commands.size();
+
+            commands.push_back(command);
+            draws.push_back(object.instance);
+        }
+
+        return (commands.size() - previousCount);
+    }
+
+
+    void GpuCuller::clearFields() noexcept {
+        frustumPlanesUniform = {};
+        objectCountUniform = {};
+        objects.clear();
+        dirtyBegin = 0;
+        dirtyEnd = 0;
+        bufferCapacity = 0;
+        objectBufferId = 0;
+        commandBufferId = 0;
+        drawDataBufferId = 0;
+        drawCountBufferId = 0;
+    }
+
+    void GpuCuller::moveFrom(GpuCuller &other) noexcept {
+        if (this == &other) return;
+
+        frustumPlanesUniform = other.frustumPlanesUniform;
+        objectCountUniform = other.objectCountUniform;
+        objects = std::move(other.objects);
+        dirtyBegin = other.dirtyBegin;
+        dirtyEnd = other.dirtyEnd;
+        bufferCapacity = other.bufferCapacity;
+        objectBufferId = other.objectBufferId;
+        commandBufferId = other.commandBufferId;
+        drawDataBufferId = other.drawDataBufferId;
+        drawCountBufferId = other.drawCountBufferId;
+
+        other.clearFields();
+    }
+
+    void GpuCuller::destroy() noexcept {
+        for (const uint32_t id: {objectBufferId, commandBufferId, drawDataBufferId, drawCountBufferId}) {
+            if (id != 0) glDeleteBuffers(1, &id);
+        }
+        objectBufferId = 0;
+        commandBufferId = 0;
+        drawDataBufferId = 0;
+        drawCountBufferId = 0;
+        bufferCapacity = 0;
+    }
+
+    void GpuCuller::markDirty(size_t index) noexcept {
+        if (dirtyBegin == dirtyEnd) {
+            dirtyBegin = index;
+            dirtyEnd = (index + 1);
+            return;
+        }
+
+        dirtyBegin = std::min(dirtyBegin, index);
+        dirtyEnd = std::max(dirtyEnd, (index + 1));
+    }
+
+    void GpuCuller::upload() {
+        if (objects.size() > bufferCapacity) {
+            // Regrown whole with room to spare, so adding objects one at a time doesn't reallocate every frame
+            const size_t capacity = std::max(objects.size(), (bufferCapacity * 2));
+            destroy();
+
+            glCreateBuffers(1, &objectBufferId);
+            glNamedBufferStorage(objectBufferId, (capacity * sizeof(CullObject)), nullptr, GL_DYNAMIC_STORAGE_BIT);
+            glCreateBuffers(1, &commandBufferId);
+            glNamedBufferStorage(commandBufferId, (capacity * sizeof(DrawElementsIndirectCommand)), nullptr, 0);
+            glCreateBuffers(1, &drawDataBufferId);
+            glNamedBufferStorage(drawDataBufferId, (capacity * sizeof(Instance)), nullptr, 0);
+            glCreateBuffers(1, &drawCountBufferId);
+            glNamedBufferStorage(drawCountBufferId, sizeof(uint32_t), nullptr, 0);
+
+            bufferCapacity = capacity;
+            dirtyBegin = 0;
+            dirtyEnd = objects.size();
+        }
+
+        if (dirtyBegin != dirtyEnd) {
+            glNamedBufferSubData(objectBufferId, (dirtyBegin * sizeof(CullObject)), ((dirtyEnd - dirtyBegin) * sizeof(CullObject)), (objects.data() + dirtyBegin));
+            dirtyBegin = 0;
+            dirtyEnd = 0;
+        }
+    }
+
+    GpuCuller::GpuCuller(const std::filesystem::path &cullShaderPath): cullShader(cullShaderPath) {
+        frustumPlanesUniform = cullShader.getUniformHandle("frustumPlanes");
+        objectCountUniform = cullShader.getUniformHandle("objectCount");
+    }
+
+    GpuCuller::GpuCuller(GpuCuller &&other): cullShader(std::move(other.cullShader)) {
+        this->moveFrom(other);
+    }
+
+    size_t GpuCuller::add(const BatchMesh &mesh, const Bounds &bounds, const Instance &instance) {
+        CullObject object;
+        object.instance = instance;
+        object.bounds = Vector4(bounds.center.x, bounds.center.y, bounds.center.z, bounds.radius);
+        object.indexCount = mesh.indexCount;
+        object.firstIndex = mesh.firstIndex;
+        object.baseVertex = mesh.baseVertex;
+
+        objects.push_back(object);
+        markDirty(objects.size() - 1);
+        return (objects.size() - 1);
+    }
+
+    void GpuCuller::setInstance(size_t index, const Instance &instance) {
+        if (index >= objects.size()) {
+            throw std::invalid_argument("Cull object index " + std::to_string(index) + " is out of range:\n" + std::to_string(std::stacktrace::current()));
+        }
+
+        objects[index].instance = instance;
+        markDirty(index);
+    }
+
+    const CullObject &GpuCuller::getObject(size_t index) const {
+        if (index >= objects.size()) {
+            throw std::invalid_argument("Cull object index " + std::to_string(index) + " is out of range:\n" + std::to_string(std::stacktrace::current()));
+        }
+        return objects[index];
+    }
+
+    std::span<const CullObject> GpuCuller::getObjects() const noexcept {return objects;}
+    size_t GpuCuller::getObjectCount() const noexcept {return objects.size();}
+
+    void GpuCuller::clear() noexcept {
+        objects.clear();
+        dirtyBegin = 0;
+        dirtyEnd = 0;
+    }
+
+    void GpuCuller::cull(const Matrix4 &viewProjection) {
+        if (objects.empty()) return;
+        upload();
+
+        CG_PROFILE_GPU_ZONE("Cull");
+
+        const Frustum frustum = Frustum::fromViewProjection(viewProjection);
+        cullShader.setUniform<Vector4>(frustumPlanesUniform, std::span<const Vector4>(frustum.planes));
+        cullShader.setUniform<uint32_t>(objectCountUniform, static_cast<uint32_t>(objects.size()));
+
+        glClearNamedBufferData(drawCountBufferId, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr); // Zero
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, objectBinding, objectBufferId, 0, (objects.size() * sizeof(CullObject)));
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, commandBinding, commandBufferId);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, drawDataBinding, drawDataBufferId);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, drawCountBinding, drawCountBufferId);
+
+        cullShader.dispatch(static_cast<uint32_t>((objects.size() + workGroupSize - 1) / workGroupSize));
+
+        // The draw reads the commands and count as indirect arguments, and the instances from an SSBO
+        memoryBarrier(GpuBarrier::Command | GpuBarrier::ShaderStorage);
+    }
+
+    void GpuCuller::submit(DrawBatch &meshes) {
+        if (objects.empty() || (bufferCapacity == 0)) return;
+
+        meshes.bindArena();
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DrawBatch::drawDataBinding, drawDataBufferId);
+
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBufferId);
+        glBindBuffer(GL_PARAMETER_BUFFER, drawCountBufferId);
+        glMultiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, 0, static_cast<GLsizei>(std::min(objects.size(), bufferCapacity)), 0);
+        glBindBuffer(GL_PARAMETER_BUFFER, 0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+
+    uint32_t GpuCuller::readDrawCount() const {
+        if (drawCountBufferId == 0) return 0;
+
+        uint32_t result = 0;
+        glGetNamedBufferSubData(drawCountBufferId, 0, sizeof(uint32_t), &result);
+        return result;
+    }
+
+    std::vector<Instance> GpuCuller::readDraws() const {
+        std::vector<Instance> result(readDrawCount());
+        if (!result.empty()) glGetNamedBufferSubData(drawDataBufferId, 0, (result.size() * sizeof(Instance)), result.data());
+        return result;
+    }
+
+    GpuCuller &GpuCuller::operator=(GpuCuller &&other) {
+        if (this != &other) {
+            destroy();
+            cullShader = std::move(other.cullShader);
+            this->moveFrom(other);
+        }
+        return (*this);
+    }
+
+    GpuCuller::~GpuCuller() noexcept {destroy();}
+}
\ No newline at end of file
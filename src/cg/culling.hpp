@@ -0,0 +1,81 @@
+#pragma once
+
+#include "_cgControl.hpp"
+#include "shader.hpp"
+#include "drawBatch.hpp"
+#include "components.hpp"
+
+namespace CG {
+    // Planes of a view projection's clip volume, normals pointing inside and normalized, so a plane's dot with a point is its distance
+    struct Frustum {
+        std::array<Vector4, 6> planes; // Left, right, bottom, top, then near and far in the projection's depth order
+
+        static Frustum fromViewProjection(const Matrix4 &viewProjection) noexcept;
+
+        bool intersects(const Vector3 &center, float32_t radius) const noexcept; // Conservative, spheres just outside a corner pass
+    };
+
+
+    // One object resident in a 'GpuCuller', laid out like the cull shader's std430 'Object' struct
+    struct CullObject {
+        Instance instance;
+        Vector4 bounds; // Sphere in the mesh's local space, center then radius
+        uint32_t indexCount = 0;
+        uint32_t firstIndex = 0;
+        int32_t baseVertex = 0;
+        uint32_t padding = 0;
+    };
+
+
+    Bounds transformBounds(const Bounds &bounds, const Matrix4 &model) noexcept; // Radius grows by the largest axis scale
+
+    // Reference for the cull shader, no GL involved: appends the objects intersecting the frustum as draws of a 'DrawBatch' would.
+    // The shader produces the same set, in whatever order its invocations finish.
+    size_t cullOnCpu(const Frustum &frustum, std::span<const CullObject> objects, std::vector<DrawElementsIndirectCommand> &commands, std::vector<Instance> &draws);
+
+
+    // Objects kept on the GPU and culled there: a compute shader tests each one's bounds against the frustum and compacts the survivors
+    // into an indirect command buffer, drawn with glMultiDrawElementsIndirectCount. Past uploading changed objects, the CPU cost per frame
+    // is a dispatch and a draw, whatever the object count. Meshes come from a 'DrawBatch' arena, drawn with a shader reading the
+    // survivors' 'Instance' by gl_DrawID like the batch's own draws.
+    class GpuCuller {
+        private:
+            Shader cullShader;
+            UniformHandle frustumPlanesUniform, objectCountUniform;
+            std::vector<CullObject> objects;
+            size_t dirtyBegin = 0, dirtyEnd = 0; // Objects not uploaded yet
+            size_t bufferCapacity = 0; // Objects the buffers have room for
+            uint32_t objectBufferId = 0, commandBufferId = 0, drawDataBufferId = 0, drawCountBufferId = 0;
+
+            void clearFields() noexcept;
+            void moveFrom(GpuCuller &other) noexcept; // Everything but the shader, moved by the caller
+            void destroy() noexcept;
+            void markDirty(size_t index) noexcept;
+            void upload();
+
+        public:
+            static constexpr uint32_t objectBinding = 1, commandBinding = 2, drawDataBinding = 3, drawCountBinding = 4; // Of the cull shader
+            static constexpr uint32_t workGroupSize = 64; // The cull shader's local_size_x
+
+            explicit GpuCuller(const std::filesystem::path &cullShaderPath = "./assets/shaders/cull.shader");
+            GpuCuller(const GpuCuller &) = delete;
+            GpuCuller(GpuCuller &&other);
+
+            size_t add(const BatchMesh &mesh, const Bounds &bounds, const Instance &instance = {}); // Returns the index to update it through
+            void setInstance(size_t index, const Instance &instance);
+            const CullObject &getObject(size_t index) const;
+            std::span<const CullObject> getObjects() const noexcept;
+            size_t getObjectCount() const noexcept;
+            void clear() noexcept;
+
+            void cull(const Matrix4 &viewProjection); // Only dispatches, nothing is read back
+            void submit(DrawBatch &meshes); // With the caller's draw shader bound, draws what the last 'cull' kept
+            uint32_t readDrawCount() const; // Waits for the last 'cull' to finish, for stats and debugging only
+            std::vector<Instance> readDraws() const; // What the last 'cull' kept, in the shader's order. Waits like 'readDrawCount', for checks against 'cullOnCpu'.
+
+            GpuCuller &operator=(const GpuCuller &) = delete;
+            GpuCuller &operator=(GpuCuller &&other);
+
+            ~GpuCuller() noexcept;
+    };
+}
\ No newline at end of file
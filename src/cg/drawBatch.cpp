@@ -0,0 +1,153 @@
+#include "drawBatch.hpp"
+
+namespace CG {
+    static_assert(sizeof(DrawElementsIndirectCommand) == (5 * sizeof(uint32_t)));
+    static_assert(sizeof(Instance) == ((16 + 4 + 4) * sizeof(float32_t)), "Instance must match the std430 'Draw' struct");
+
+    void DrawBatch::clearFields() noexcept {
+        vertexData.clear();
+        indexData.clear();
+        vertexSize = 0;
+        enableVertexAttributes = nullptr;
+        vertexBufferId = 0;
+        indexBufferId = 0;
+        arenaChanged = false;
+        commands.clear();
+        drawData.clear();
+        storageAlignment = 0;
+    }
+
+    void DrawBatch::moveFrom(DrawBatch &other) noexcept {
+        if (this == &other) return;
+
+        vertexData = std::move(other.vertexData);
+        indexData = std::move(other.indexData);
+        vertexSize = other.vertexSize;
+        enableVertexAttributes = other.enableVertexAttributes;
+        vertexBufferId = other.vertexBufferId;
+        indexBufferId = other.indexBufferId;
+        arenaChanged = other.arenaChanged;
+        commands = std::move(other.commands);
+        drawData = std::move(other.drawData);
+        storageAlignment = other.storageAlignment;
+
+        other.clearFields();
+    }
+
+    void DrawBatch::destroyArena() noexcept {
+        if (vertexBufferId != 0) glDeleteBuffers(1, &vertexBufferId);
+        if (indexBufferId != 0) glDeleteBuffers(1, &indexBufferId);
+        vertexBufferId = 0;
+        indexBufferId = 0;
+    }
+
+    void DrawBatch::setVertexLayout(size_t vertexSize, void (*enableVertexAttributes)()) {
+        if (this->enableVertexAttributes == nullptr) {
+            this->vertexSize = vertexSize;
+            this->enableVertexAttributes = enableVertexAttributes;
+            return;
+        }
+
+        if ((this->vertexSize != vertexSize) || (this->enableVertexAttributes != enableVertexAttributes)) {
+            throw std::invalid_argument("Meshes of one draw batch must share their vertex type:\n" + std::to_string(std::stacktrace::current()));
+        }
+    }
+
+    BatchMesh DrawBatch::addIndices(const IndexList &indices, size_t firstVertex) {
+        BatchMesh result;
+        result.firstIndex = indexData.size();
+        result.indexCount = indices.getCount();
+        result.baseVertex = firstVertex;
+
+        indexData.reserve(indexData.size() + indices.getCount());
+        for (size_t i = 0; i < indices.getCount(); ++i) indexData.push_back(indices.getAt(i));
+
+        arenaChanged = true;
+        return result;
+    }
+
+    void DrawBatch::uploadArena() {
+        // Rebuilt whole, meshes are expected to be added at load time rather than every frame
+        destroyArena();
+
+        glCreateBuffers(1, &vertexBufferId);
+        glNamedBufferStorage(vertexBufferId, vertexData.size(), vertexData.data(), 0);
+        glCreateBuffers(1, &indexBufferId);
+        glNamedBufferStorage(indexBufferId, (indexData.size() * sizeof(uint32_t)), indexData.data(), 0);
+
+        arenaChanged = false;
+    }
+
+    DrawBatch::DrawBatch(size_t drawCapacity):
+        commandStream(drawCapacity * sizeof(DrawElementsIndirectCommand)), drawDataStream(drawCapacity * sizeof(Instance)) {
+
+        GLint alignment = 0;
+        glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        storageAlignment = std::max<size_t>(alignment, alignof(Instance));
+    }
+
+    DrawBatch::DrawBatch(DrawBatch &&other) noexcept: commandStream(std::move(other.commandStream)), drawDataStream(std::move(other.drawDataStream)) {
+        this->moveFrom(other);
+    }
+
+    void DrawBatch::draw(const BatchMesh &mesh, const Instance &data) {
+        DrawElementsIndirectCommand command;
+        command.count = mesh.indexCount;
+        command.instanceCount = 1;
+        command.firstIndex = mesh.firstIndex;
+        command.baseVertex = mesh.baseVertex;
+        command.baseInstance = commands.size(); // Also exposes the draw index as gl_BaseInstance
+
+        commands.push_back(command);
+        drawData.push_back(data);
+    }
+
+    size_t DrawBatch::getDrawCount() const noexcept {return commands.size();}
+    size_t DrawBatch::getMeshVertexCount() const noexcept {return ((vertexSize == 0)? 0:(vertexData.size() / vertexSize));}
+    size_t DrawBatch::getMeshIndexCount() const noexcept {return indexData.size();}
+
+    void DrawBatch::bindArena() {
+        if (enableVertexAttributes == nullptr) return; // No mesh added yet
+        if (arenaChanged) uploadArena();
+
+        glBindBuffer(GL_ARRAY_BUFFER, vertexBufferId);
+        enableVertexAttributes();
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferId);
+    }
+
+    void DrawBatch::submit() {
+        if (commands.empty()) return;
+
+        const size_t commandBytes = (commands.size() * sizeof(DrawElementsIndirectCommand)), drawDataBytes = (drawData.size() * sizeof(Instance));
+        const StreamingBuffer::Allocation commandAllocation = commandStream.allocate(commandBytes, alignof(DrawElementsIndirectCommand));
+        const StreamingBuffer::Allocation drawDataAllocation = drawDataStream.allocate(drawDataBytes, storageAlignment);
+        std::memcpy(commandAllocation.data, commands.data(), commandBytes);
+        std::memcpy(drawDataAllocation.data, drawData.data(), drawDataBytes);
+
+        bindArena();
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, drawDataBinding, drawDataStream.getId(), drawDataAllocation.offset, drawDataBytes);
+
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandStream.getId());
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, std::bit_cast<const void *>(commandAllocation.offset), commands.size(), 0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+        clearDraws();
+    }
+
+    void DrawBatch::clearDraws() noexcept {
+        commands.clear();
+        drawData.clear();
+    }
+
+    DrawBatch &DrawBatch::operator=(DrawBatch &&other) noexcept {
+        if (this != &other) {
+            destroyArena();
+            commandStream = std::move(other.commandStream);
+            drawDataStream = std::move(other.drawDataStream);
+            this->moveFrom(other);
+        }
+        return (*this);
+    }
+
+    DrawBatch::~DrawBatch() noexcept {destroyArena();}
+}
\ No newline at end of file
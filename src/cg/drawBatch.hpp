@@ -0,0 +1,90 @@
+#pragma once
+
+#include "_cgControl.hpp"
+#include "vertex.hpp"
+#include "streamingBuffer.hpp"
+#include "instanceBuffer.hpp"
+
+namespace CG {
+    // Layout read by glMultiDrawElementsIndirect
+    struct DrawElementsIndirectCommand {
+        uint32_t count = 0;
+        uint32_t instanceCount = 0;
+        uint32_t firstIndex = 0;
+        int32_t baseVertex = 0;
+        uint32_t baseInstance = 0;
+    };
+
+
+    // A mesh's range in its batch's arena
+    struct BatchMesh {
+        uint32_t firstIndex = 0;
+        uint32_t indexCount = 0;
+        int32_t baseVertex = 0;
+    };
+
+
+    // Meshes sharing one vertex layout, merged in one vertex and one index buffer, so every draw queued in a frame goes out in a single
+    // glMultiDrawElementsIndirect. Each draw's 'Instance' is read from an SSBO by gl_DrawID, in GLSL:
+    // layout (std430, binding = 0) readonly buffer DrawData {Draw draws[];}; with 'struct Draw {mat4 model; vec4 color; vec4 uvTransform;};'
+    class DrawBatch {
+        private:
+            std::vector<std::byte> vertexData;
+            std::vector<uint32_t> indexData; // Widened, so every mesh shares one index type
+            size_t vertexSize = 0;
+            void (*enableVertexAttributes)() = nullptr; // Of the first mesh's vertex type, the others must match
+            uint32_t vertexBufferId = 0, indexBufferId = 0;
+            bool arenaChanged = false;
+
+            std::vector<DrawElementsIndirectCommand> commands;
+            std::vector<Instance> drawData;
+            StreamingBuffer commandStream, drawDataStream;
+            size_t storageAlignment = 0;
+
+            void clearFields() noexcept;
+            void moveFrom(DrawBatch &other) noexcept; // Everything but the streams, which have no empty state to construct from
+            void destroyArena() noexcept;
+            void setVertexLayout(size_t vertexSize, void (*enableVertexAttributes)());
+            BatchMesh addIndices(const IndexList &indices, size_t firstVertex);
+            void uploadArena();
+
+        public:
+            static constexpr uint32_t drawDataBinding = 0;
+            static constexpr size_t defaultDrawCapacity = 4096; // Draws per frame before the streams grow
+
+            explicit DrawBatch(size_t drawCapacity = defaultDrawCapacity);
+            DrawBatch(const DrawBatch &) = delete;
+            DrawBatch(DrawBatch &&other) noexcept;
+
+            template<validVertexType T, size_t spanCount> BatchMesh addMesh(std::span<const T, spanCount> vertices, const IndexList &indices);
+            template<validVertexType T> BatchMesh addMesh(const std::vector<T> &vertices, const IndexList &indices);
+
+            void draw(const BatchMesh &mesh, const Instance &data = {}); // Queued until 'submit'
+            size_t getDrawCount() const noexcept; // Queued
+            size_t getMeshVertexCount() const noexcept; // In the arena
+            size_t getMeshIndexCount() const noexcept;
+            void bindArena(); // Uploads the meshes if any were added since, then binds their vertex and index buffers
+            void submit(); // With the caller's shader bound, then clears the queue
+            void clearDraws() noexcept;
+
+            DrawBatch &operator=(const DrawBatch &) = delete;
+            DrawBatch &operator=(DrawBatch &&other) noexcept;
+
+            ~DrawBatch() noexcept;
+    };
+
+
+    template<validVertexType T, size_t spanCount>
+    BatchMesh DrawBatch::addMesh(std::span<const T, spanCount> vertices, const IndexList &indices) {
+        setVertexLayout(sizeof(T), T::enableVertexAttributes);
+
+        const size_t firstVertex = (vertexData.size() / sizeof(T));
+        const std::span<const std::byte> bytes = std::as_bytes(vertices);
+        vertexData.insert(vertexData.end(), bytes.begin(), bytes.end());
+
+        return addIndices(indices, firstVertex);
+    }
+
+    template<validVertexType T>
+    BatchMesh DrawBatch::addMesh(const std::vector<T> &vertices, const IndexList &indices) {return addMesh(std::span(vertices), indices);}
+}
\ No newline at end of file
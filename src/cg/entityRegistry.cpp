@@ -0,0 +1,42 @@
+#include "entityRegistry.hpp"
+
+namespace CG {
+    size_t EntityRegistry::nextComponentTypeId() noexcept {
+        static std::atomic<size_t> nextId = 0;
+        return nextId++;
+    }
+
+    Entity EntityRegistry::create() {
+        Entity result;
+        if (freeIndices.empty()) {
+            result.index = generations.size();
+            generations.push_back(0);
+        }
+        else {
+            result.index = freeIndices.back();
+            freeIndices.pop_back();
+        }
+
+        result.generation = generations[result.index];
+        ++aliveCount;
+        return result;
+    }
+
+    void EntityRegistry::destroy(Entity entity) {
+        if (!isAlive(entity)) return;
+
+        for (const auto &pool: pools) {
+            if (pool != nullptr) pool->remove(entity);
+        }
+
+        ++generations[entity.index];
+        freeIndices.push_back(entity.index);
+        --aliveCount;
+    }
+
+    bool EntityRegistry::isAlive(Entity entity) const noexcept {
+        return (entity.isValid() && (entity.index < generations.size()) && (generations[entity.index] == entity.generation));
+    }
+
+    size_t EntityRegistry::getCount() const noexcept {return aliveCount;}
+}
\ No newline at end of file
@@ -0,0 +1,241 @@
+#pragma once
+
+#include "_cgControl.hpp"
+#include "jobSystem.hpp"
+
+namespace CG {
+    // Index plus generation, so a handle to a destroyed entity never aliases the one reusing its slot
+    struct Entity {
+        static constexpr uint32_t invalidIndex = std::numeric_limits<uint32_t>::max();
+
+        uint32_t index = invalidIndex;
+        uint32_t generation = 0;
+
+        constexpr bool isValid() const noexcept {return (index != invalidIndex);}
+        constexpr bool operator==(const Entity &) const noexcept = default;
+    };
+
+
+    class ComponentPoolBase {
+        public:
+            static constexpr uint32_t absent = std::numeric_limits<uint32_t>::max();
+
+            virtual ~ComponentPoolBase() noexcept = default;
+
+            virtual bool has(Entity entity) const noexcept = 0;
+            virtual void remove(Entity entity) = 0;
+            virtual size_t getCount() const noexcept = 0;
+    };
+
+
+    // Sparse set: components packed contiguously, with the entity owning each one alongside. Removal swaps the last one in.
+    template<typename T>
+    class ComponentPool: public ComponentPoolBase {
+        private:
+            std::vector<uint32_t> sparse; // By entity index, dense index or 'absent'
+            std::vector<Entity> entities;
+            std::vector<T> components;
+
+        public:
+            template<typename ...Args> T &add(Entity entity, Args &&...args);
+            bool has(Entity entity) const noexcept override;
+            void remove(Entity entity) override;
+            size_t getCount() const noexcept override;
+
+            T &get(Entity entity);
+            const T &get(Entity entity) const;
+            T *tryGet(Entity entity) noexcept;
+
+            std::span<T> getComponents() noexcept;
+            std::span<const T> getComponents() const noexcept;
+            std::span<const Entity> getEntities() const noexcept; // Same order as the components
+    };
+
+
+    // Entities and their components. Every component type gets its own pool, iteration walks the smallest pool involved and looks the others up.
+    // Adding or removing components or entities while iterating is not allowed.
+    class EntityRegistry {
+        private:
+            std::vector<uint32_t> generations; // By entity index
+            std::vector<uint32_t> freeIndices;
+            std::vector<std::unique_ptr<ComponentPoolBase>> pools; // By component type id
+            size_t aliveCount = 0;
+
+            static size_t nextComponentTypeId() noexcept;
+            template<typename T> static size_t getComponentTypeId() noexcept;
+
+            template<typename Driver, typename ...Ts, typename Function> static void forEachIn(const std::tuple<ComponentPool<Ts> &...> &pools, size_t begin, size_t end, Function &function);
+
+        public:
+            Entity create();
+            void destroy(Entity entity); // With all its components
+            bool isAlive(Entity entity) const noexcept;
+            size_t getCount() const noexcept;
+
+            template<typename T> ComponentPool<T> &getPool();
+            template<typename T, typename ...Args> T &add(Entity entity, Args &&...args);
+            template<typename T> void remove(Entity entity);
+            template<typename T> bool has(Entity entity) const noexcept;
+            template<typename T> T &get(Entity entity);
+            template<typename T> T *tryGet(Entity entity) noexcept;
+
+            // 'function(entity, components &...)' for every entity that has all of 'Ts'
+            template<typename ...Ts, typename Function> void forEach(Function &&function);
+
+            // Same, with the entities split in chunks of 'chunkSize' run as 'JobSystem' jobs, the caller running some too, or all of them while the job system
+            // isn't running. 'function' must be safe to call concurrently.
+            template<typename ...Ts, typename Function> void parallelForEach(Function &&function, size_t chunkSize = defaultChunkSize);
+
+            static constexpr size_t defaultChunkSize = 1024;
+    };
+
+
+    template<typename T>
+    template<typename ...Args>
+    T &ComponentPool<T>::add(Entity entity, Args &&...args) {
+        ASSERT(entity.isValid());
+        if (has(entity)) return (components[sparse[entity.index]] = T(std::forward<Args>(args)...)); // Built as 'emplace_back' would
+
+        if (entity.index >= sparse.size()) sparse.resize((entity.index + 1), absent);
+        sparse[entity.index] = entities.size();
+        entities.push_back(entity);
+        return components.emplace_back(std::forward<Args>(args)...);
+    }
+
+    template<typename T>
+    bool ComponentPool<T>::has(Entity entity) const noexcept {
+        return ((entity.index < sparse.size()) && (sparse[entity.index] != absent) && (entities[sparse[entity.index]] == entity));
+    }
+
+    template<typename T>
+    void ComponentPool<T>::remove(Entity entity) {
+        if (!has(entity)) return;
+
+        const uint32_t index = sparse[entity.index];
+        const uint32_t last = (entities.size() - 1);
+        if (index != last) {
+            entities[index] = entities[last];
+            components[index] = std::move(components[last]);
+            sparse[entities[index].index] = index;
+        }
+
+        entities.pop_back();
+        components.pop_back();
+        sparse[entity.index] = absent;
+    }
+
+    template<typename T>
+    size_t ComponentPool<T>::getCount() const noexcept {return components.size();}
+
+    template<typename T>
+    T &ComponentPool<T>::get(Entity entity) {
+        ASSERT(has(entity));
+        return components[sparse[entity.index]];
+    }
+
+    template<typename T>
+    const T &ComponentPool<T>::get(Entity entity) const {
+        ASSERT(has(entity));
+        return components[sparse[entity.index]];
+    }
+
+    template<typename T>
+    T *ComponentPool<T>::tryGet(Entity entity) noexcept {
+        return (has(entity)? &components[sparse[entity.index]]:nullptr);
+    }
+
+    template<typename T> std::span<T> ComponentPool<T>::getComponents() noexcept {return components;}
+    template<typename T> std::span<const T> ComponentPool<T>::getComponents() const noexcept {return components;}
+    template<typename T> std::span<const Entity> ComponentPool<T>::getEntities() const noexcept {return entities;}
+
+
+    template<typename T>
+    size_t EntityRegistry::getComponentTypeId() noexcept {
+        static const size_t id = nextComponentTypeId();
+        return id;
+    }
+
+    template<typename T>
+    ComponentPool<T> &EntityRegistry::getPool() {
+        const size_t id = getComponentTypeId<T>();
+        if (id >= pools.size()) pools.resize(id + 1);
+        if (pools[id] == nullptr) pools[id] = std::make_unique<ComponentPool<T>>();
+        return static_cast<ComponentPool<T> &>(*pools[id]);
+    }
+
+    template<typename T, typename ...Args>
+    T &EntityRegistry::add(Entity entity, Args &&...args) {
+        ASSERT(isAlive(entity));
+        return getPool<T>().add(entity, std::forward<Args>(args)...);
+    }
+
+    template<typename T>
+    void EntityRegistry::remove(Entity entity) {
+        getPool<T>().remove(entity);
+    }
+
+    template<typename T>
+    bool EntityRegistry::has(Entity entity) const noexcept {
+        const size_t id = getComponentTypeId<T>();
+        return ((id < pools.size()) && (pools[id] != nullptr) && pools[id]->has(entity));
+    }
+
+    template<typename T>
+    T &EntityRegistry::get(Entity entity) {
+        return getPool<T>().get(entity);
+    }
+
+    template<typename T>
+    T *EntityRegistry::tryGet(Entity entity) noexcept {
+        return getPool<T>().tryGet(entity);
+    }
+
+    template<typename Driver, typename ...Ts, typename Function>
+    void EntityRegistry::forEachIn(const std::tuple<ComponentPool<Ts> &...> &pools, size_t begin, size_t end, Function &function) {
+        const std::span<const Entity> entities = std::get<ComponentPool<Driver> &>(pools).getEntities();
+        const std::span<Driver> drivers = std::get<ComponentPool<Driver> &>(pools).getComponents();
+
+        for (size_t i = begin; i < end; ++i) {
+            const Entity entity = entities[i];
+            if (!(std::get<ComponentPool<Ts> &>(pools).has(entity) && ...)) continue;
+
+            const auto component = [&]<typename T>(std::type_identity<T>) -> T & {
+                if constexpr (std::is_same_v<T, Driver>) return drivers[i];
+                else return std::get<ComponentPool<T> &>(pools).get(entity);
+            };
+            function(entity, component(std::type_identity<Ts>())...);
+        }
+    }
+
+    template<typename ...Ts, typename Function>
+    void EntityRegistry::forEach(Function &&function) {
+        static_assert(sizeof...(Ts) > 0);
+        parallelForEach<Ts...>(std::forward<Function>(function), std::numeric_limits<size_t>::max()); // A single chunk, run by the caller
+    }
+
+    template<typename ...Ts, typename Function>
+    void EntityRegistry::parallelForEach(Function &&function, size_t chunkSize) {
+        static_assert(sizeof...(Ts) > 0);
+
+        // Walks the smallest pool
+        const std::array<size_t, sizeof...(Ts)> counts = {getPool<Ts>().getCount()...};
+        const size_t smallest = static_cast<size_t>(std::min_element(counts.begin(), counts.end()) - counts.begin());
+        const size_t count = counts[smallest];
+        if (count == 0) return;
+
+        // Pools are all created up front, jobs only read them
+        const std::tuple<ComponentPool<Ts> &...> pools = {getPool<Ts>()...};
+
+        const auto run = [&]<size_t driverIndex>(std::integral_constant<size_t, driverIndex>) {
+            using Driver = std::tuple_element_t<driverIndex, std::tuple<Ts...>>;
+
+            JobSystem::parallelFor(count, [&](size_t begin, size_t end) {
+                forEachIn<Driver, Ts...>(pools, begin, end, function);
+            }, chunkSize);
+        };
+
+        [&]<size_t ...indices>(std::index_sequence<indices...>) {
+            (((smallest == indices) && (run(std::integral_constant<size_t, indices>()), true)) || ...);
+        }(std::index_sequence_for<Ts...>());
+    }
+}
\ No newline at end of file
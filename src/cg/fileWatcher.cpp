@@ -0,0 +1,107 @@
+#include "fileWatcher.hpp"
+#include "shaderSource.hpp"
+
+#if defined(__linux__)
+    #include <poll.h>
+    #include <unistd.h>
+    #include <sys/inotify.h>
+#endif
+
+namespace CG {
+    void FileWatcher::addChange(const std::filesystem::path &path) {
+        const std::filesystem::path normalized = ShaderSources::normalize(path);
+
+        const std::lock_guard lock(mutex);
+        if (std::find(changes.begin(), changes.end(), normalized) == changes.end()) changes.push_back(normalized);
+    }
+
+    void FileWatcher::pollModificationTimes() {
+        std::unordered_map<std::string, std::filesystem::file_time_type> modifiedTimes;
+        bool firstScan = true;
+
+        while (running) {
+            std::error_code error;
+            auto iter = std::filesystem::recursive_directory_iterator(root, std::filesystem::directory_options::skip_permission_denied, error);
+            for (; !error && (iter != std::filesystem::recursive_directory_iterator()); iter.increment(error)) {
+                if (!iter->is_regular_file(error)) continue;
+
+                const std::filesystem::file_time_type modifiedTime = iter->last_write_time(error);
+                if (error) break;
+
+                // New files count too, once the first scan has seen what was already there
+                const auto [known, inserted] = modifiedTimes.try_emplace(iter->path().string(), modifiedTime);
+                if ((inserted && !firstScan) || (!inserted && (known->second != modifiedTime))) addChange(iter->path());
+                known->second = modifiedTime;
+            }
+
+            firstScan = false;
+            std::this_thread::sleep_for(interval);
+        }
+    }
+
+    void FileWatcher::watchInotify() {
+        #if defined(__linux__)
+            const int descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            if (descriptor < 0) {
+                pollModificationTimes();
+                return;
+            }
+
+            // inotify isn't recursive, every directory gets its own watch
+            std::unordered_map<int, std::filesystem::path> directories;
+            const auto watchDirectory = [&](const std::filesystem::path &directory) {
+                const int watch = inotify_add_watch(descriptor, directory.c_str(), (IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE));
+                if (watch >= 0) directories[watch] = directory;
+            };
+
+            std::error_code error;
+            watchDirectory(root);
+            auto iter = std::filesystem::recursive_directory_iterator(root, std::filesystem::directory_options::skip_permission_denied, error);
+            for (; !error && (iter != std::filesystem::recursive_directory_iterator()); iter.increment(error)) {
+                if (iter->is_directory(error)) watchDirectory(iter->path());
+            }
+
+            alignas(inotify_event) char buffer[4096];
+            while (running) {
+                pollfd pollDescriptor = {descriptor, POLLIN, 0};
+                if (poll(&pollDescriptor, 1, static_cast<int>(interval.count())) <= 0) continue;
+
+                const ssize_t length = read(descriptor, buffer, sizeof(buffer));
+                for (ssize_t offset = 0; offset < length;) {
+                    const inotify_event &event = *reinterpret_cast<const inotify_event *>(buffer + offset);
+                    offset += (sizeof(inotify_event) + event.len);
+
+                    const auto directory = directories.find(event.wd);
+                    if ((directory == directories.end()) || (event.len == 0)) continue;
+
+                    // Editors that save through a temporary file show up as a move
+                    const std::filesystem::path path = (directory->second / event.name);
+                    if (event.mask & IN_ISDIR) watchDirectory(path);
+                    else if (event.mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) addChange(path);
+                }
+            }
+
+            close(descriptor);
+        #else
+            pollModificationTimes();
+        #endif
+    }
+
+    FileWatcher::FileWatcher(const std::filesystem::path &root, std::chrono::milliseconds interval): root(root), interval(interval) {
+        if (!std::filesystem::is_directory(root)) {
+            throw std::runtime_error("Can't watch \"" + root.string() + "\", it isn't a directory:\n" + std::to_string(std::stacktrace::current()));
+        }
+
+        thread = std::thread(&FileWatcher::watchInotify, this);
+    }
+
+    std::vector<std::filesystem::path> FileWatcher::takeChanges() {
+        const std::lock_guard lock(mutex);
+        return std::exchange(changes, {});
+    }
+
+    FileWatcher::~FileWatcher() noexcept {
+        running = false;
+        thread.join();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include "_cgControl.hpp"
+
+namespace CG {
+    // Reports files written under a directory tree, watched from a background thread. inotify on Linux, modification time polling elsewhere.
+    class FileWatcher {
+        private:
+            std::filesystem::path root;
+            std::chrono::milliseconds interval;
+            std::atomic<bool> running = true;
+            std::mutex mutex;
+            std::vector<std::filesystem::path> changes; // Normalized, each at most once
+            std::thread thread;
+
+            void addChange(const std::filesystem::path &path);
+            void pollModificationTimes();
+            void watchInotify();
+
+        public:
+            static constexpr std::chrono::milliseconds defaultInterval = std::chrono::milliseconds(250); // Polling period, and how long stopping can take
+
+            explicit FileWatcher(const std::filesystem::path &root, std::chrono::milliseconds interval = defaultInterval);
+            FileWatcher(const FileWatcher &) = delete;
+
+            std::vector<std::filesystem::path> takeChanges(); // Since the last call
+
+            FileWatcher &operator=(const FileWatcher &) = delete;
+
+            ~FileWatcher() noexcept;
+    };
+}
\ No newline at end of file
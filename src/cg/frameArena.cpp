@@ -0,0 +1,141 @@
+#include <new>
+#include "frameArena.hpp"
+
+#ifndef CG_COUNT_ALLOCATIONS
+    #define CG_COUNT_ALLOCATIONS 0
+#endif
+
+namespace CG {
+    namespace {
+        std::atomic<size_t> allocationCount = 0;
+        thread_local size_t threadAllocationCount = 0;
+    }
+
+    void FrameArena::addBlock(size_t minimumSize) {
+        const size_t size = std::max(minimumSize, (blocks.empty()? 0:blocks.back().size));
+        blocks.push_back({std::make_unique_for_overwrite<std::byte[]>(size), size});
+    }
+
+    void *FrameArena::do_allocate(size_t bytes, size_t alignment) {
+        while (true) {
+            if (blockIndex < blocks.size()) {
+                const Block &block = blocks[blockIndex];
+                const uintptr_t base = std::bit_cast<uintptr_t>(block.memory.get());
+                const size_t start = ((((base + offset + alignment - 1) / alignment) * alignment) - base);
+
+                if ((start + bytes) <= block.size) {
+                    used += ((start + bytes) - offset);
+                    peak = std::max(peak, used);
+                    offset = (start + bytes);
+                    return (block.memory.get() + start);
+                }
+
+                used += (block.size - offset); // The unusable tail counts, the merged block has to cover it too
+                ++blockIndex;
+                offset = 0;
+                continue;
+            }
+
+            addBlock(bytes + alignment);
+        }
+    }
+
+    void FrameArena::do_deallocate(void *, size_t, size_t) {}
+
+    bool FrameArena::do_is_equal(const std::pmr::memory_resource &other) const noexcept {return (this == &other);}
+
+    FrameArena &FrameArena::getThread() {
+        thread_local FrameArena arena;
+        return arena;
+    }
+
+    FrameArena::FrameArena(size_t blockSize) {
+        ASSERT(blockSize > 0);
+        addBlock(blockSize);
+    }
+
+    void FrameArena::reset() {
+        // Outgrew the first block: one block as big as this frame needed replaces the chain, the only allocation is here and only after growing
+        if (blockIndex > 0) {
+            size_t total = 0;
+            for (const Block &block: blocks) total += block.size;
+
+            blocks.clear();
+            addBlock(total);
+        }
+
+        blockIndex = 0;
+        offset = 0;
+        used = 0;
+        ++resetCount;
+    }
+
+    size_t FrameArena::getUsed() const noexcept {return used;}
+    size_t FrameArena::getPeak() const noexcept {return peak;}
+
+    size_t FrameArena::getCapacity() const noexcept {
+        size_t result = 0;
+        for (const Block &block: blocks) result += block.size;
+        return result;
+    }
+
+    size_t FrameArena::getResetCount() const noexcept {return resetCount;}
+
+    std::pmr::string FrameArena::makeString(std::string_view text) {return std::pmr::string(text, this);}
+
+
+    bool AllocationCounter::isEnabled() noexcept {return CG_COUNT_ALLOCATIONS;}
+    size_t AllocationCounter::getCount() noexcept {return allocationCount.load(std::memory_order_relaxed);}
+    size_t AllocationCounter::getThreadCount() noexcept {return threadAllocationCount;}
+
+
+    AllocationScope::AllocationScope() noexcept: start(AllocationCounter::getThreadCount()) {}
+    size_t AllocationScope::getCount() const noexcept {return (AllocationCounter::getThreadCount() - start);}
+}
+
+
+#if CG_COUNT_ALLOCATIONS
+    // Replaced for the whole program, the other forms of new and delete all end up in these
+
+    namespace {
+        void *countedAllocate(size_t size, size_t alignment) {
+            CG::allocationCount.fetch_add(1, std::memory_order_relaxed);
+            ++CG::threadAllocationCount;
+
+            // Every block goes through the aligned functions, so delete doesn't need to know the alignment
+            alignment = std::max<size_t>(alignment, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+            size = std::max<size_t>((((size + alignment - 1) / alignment) * alignment), alignment);
+
+            #if defined(_WIN32)
+                void *const result = _aligned_malloc(size, alignment);
+            #else
+                void *const result = std::aligned_alloc(alignment, size);
+            #endif
+
+            if (result == nullptr) throw std::bad_alloc();
+            return result;
+        }
+
+        void countedFree(void *pointer) noexcept {
+            #if defined(_WIN32)
+                _aligned_free(pointer);
+            #else
+                std::free(pointer);
+            #endif
+        }
+    }
+
+    void *operator new(size_t size) {return countedAllocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);}
+    void *operator new[](size_t size) {return countedAllocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);}
+    void *operator new(size_t size, std::align_val_t alignment) {return countedAllocate(size, static_cast<size_t>(alignment));}
+    void *operator new[](size_t size, std::align_val_t alignment) {return countedAllocate(size, static_cast<size_t>(alignment));}
+
+    void operator delete(void *pointer) noexcept {countedFree(pointer);}
+    void operator delete[](void *pointer) noexcept {countedFree(pointer);}
+    void operator delete(void *pointer, size_t) noexcept {countedFree(pointer);}
+    void operator delete[](void *pointer, size_t) noexcept {countedFree(pointer);}
+    void operator delete(void *pointer, std::align_val_t) noexcept {countedFree(pointer);}
+    void operator delete[](void *pointer, std::align_val_t) noexcept {countedFree(pointer);}
+    void operator delete(void *pointer, size_t, std::align_val_t) noexcept {countedFree(pointer);}
+    void operator delete[](void *pointer, size_t, std::align_val_t) noexcept {countedFree(pointer);}
+#endif
\ No newline at end of file
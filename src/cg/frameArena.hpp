@@ -0,0 +1,76 @@
+#pragma once
+
+#include <memory_resource>
+#include "_cgControl.hpp"
+
+namespace CG {
+    // Bump allocator for transient data, everything it handed out is released at once by 'reset'. Use it through 'std::pmr' containers.
+    // Overflow chains extra blocks, which 'reset' merges into one big enough for the whole frame, so a steady frame never reaches the heap.
+    class FrameArena: public std::pmr::memory_resource {
+        private:
+            struct Block {
+                std::unique_ptr<std::byte[]> memory;
+                size_t size = 0;
+            };
+
+            std::vector<Block> blocks;
+            size_t blockIndex = 0, offset = 0;
+            size_t used = 0, peak = 0; // Bytes, alignment padding included
+            size_t resetCount = 0;
+
+            void addBlock(size_t minimumSize);
+
+        protected:
+            void *do_allocate(size_t bytes, size_t alignment) override;
+            void do_deallocate(void *pointer, size_t bytes, size_t alignment) override; // Nothing until 'reset'
+            bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+        public:
+            static constexpr size_t defaultBlockSize = (1 << 20);
+
+            static FrameArena &getThread(); // One per thread. Reset after every 'Window::render' on render threads, and after every outermost job on job workers.
+
+            explicit FrameArena(size_t blockSize = defaultBlockSize);
+            FrameArena(const FrameArena &) = delete;
+
+            void reset(); // Invalidates everything allocated from it
+            size_t getUsed() const noexcept;     // Since the last reset
+            size_t getPeak() const noexcept;     // Most used between two resets
+            size_t getCapacity() const noexcept;
+            size_t getResetCount() const noexcept;
+
+            template<typename T> std::pmr::vector<T> makeVector(size_t reserved = 0);
+            std::pmr::string makeString(std::string_view text = "");
+
+            FrameArena &operator=(const FrameArena &) = delete;
+    };
+
+
+    // Heap allocation counts, for checking that a steady frame doesn't allocate. Only counts when built with CG_COUNT_ALLOCATIONS=1,
+    // which replaces the global operator new and delete, 'isEnabled' tells which build this is.
+    class AllocationCounter {
+        public:
+            static bool isEnabled() noexcept;
+            static size_t getCount() noexcept;       // Every thread, since the start
+            static size_t getThreadCount() noexcept; // The calling thread, since it started
+    };
+
+
+    // Allocations the constructing thread made since this was constructed
+    class AllocationScope {
+        private:
+            size_t start = 0;
+
+        public:
+            AllocationScope() noexcept;
+            size_t getCount() const noexcept;
+    };
+
+
+    template<typename T>
+    std::pmr::vector<T> FrameArena::makeVector(size_t reserved) {
+        std::pmr::vector<T> result(this);
+        result.reserve(reserved);
+        return result;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <memory>
+#include <functional>
+#include <type_traits>
+
+namespace CG {
+    template<typename Signature> class FunctionRef;
+
+    // Non owning view of a callable, two pointers and never allocates, unlike 'std::function'.
+    // The callable has to outlive the reference, so temporaries are rejected. Functions are referred to by their address instead, which always outlives it.
+    template<typename R, typename ...Args>
+    class FunctionRef<R(Args...)> {
+        private:
+            // Any function pointer round trips through 'void (*)()', while only object pointers do through 'void *'
+            union Target {
+                void *object;
+                void (*function)();
+            };
+
+            template<typename F> static constexpr bool isFunctionPointer = std::is_function_v<std::remove_pointer_t<std::remove_cvref_t<F>>>;
+
+            Target target = {nullptr};
+            R (*invoker)(Target, Args...) = nullptr;
+
+        public:
+            FunctionRef() noexcept = default;
+
+            template<typename F> requires (std::is_object_v<F> && !isFunctionPointer<F> && !std::is_same_v<std::remove_cv_t<F>, FunctionRef> && std::is_invocable_r_v<R, F &, Args...>)
+            FunctionRef(F &callable) noexcept:
+                invoker([](Target target, Args ...args) -> R {
+                    return std::invoke(*static_cast<F *>(target.object), std::forward<Args>(args)...);
+                }) {
+                target.object = const_cast<void *>(static_cast<const void *>(std::addressof(callable)));
+            }
+
+            // Functions and function pointers, ex.: 'FunctionRef<void()>(render)' or a pointer read from a table
+            template<typename F> requires (std::is_function_v<F> && std::is_invocable_r_v<R, F &, Args...>)
+            FunctionRef(F *function) noexcept {
+                if (function == nullptr) return;
+
+                target.function = reinterpret_cast<void (*)()>(function);
+                invoker = [](Target target, Args ...args) -> R {
+                    return std::invoke(reinterpret_cast<F *>(target.function), std::forward<Args>(args)...);
+                };
+            }
+
+            template<typename F> requires (std::is_function_v<F> && std::is_invocable_r_v<R, F &, Args...>)
+            FunctionRef(F &function) noexcept: FunctionRef(std::addressof(function)) {}
+
+            template<typename F> requires (!std::is_same_v<std::remove_cvref_t<F>, FunctionRef> && !std::is_lvalue_reference_v<F> && !isFunctionPointer<F>)
+            FunctionRef(F &&) = delete;
+
+            R operator()(Args ...args) const {
+                return invoker(target, std::forward<Args>(args)...);
+            }
+
+            explicit operator bool() const noexcept {
+                return (invoker != nullptr);
+            }
+    };
+}
\ No newline at end of file
@@ -3,6 +3,16 @@
 #include "_cgControl.hpp"
 
 namespace CG {
+    // 64 bit FNV-1a, usable at compile time
+    constexpr uint64_t hashFnv1a(std::string_view text) noexcept {
+        uint64_t result = 0xcbf29ce484222325;
+        for (const char c: text) {
+            result ^= static_cast<uint8_t>(c);
+            result *= 0x100000001b3;
+        }
+        return result;
+    }
+
     struct StringViewHash {
         using is_transparent = void;
         size_t operator()(std::string_view sv) const noexcept;
@@ -0,0 +1,162 @@
+#include "hotReloader.hpp"
+#include "shader.hpp"
+#include "texture.hpp"
+#include "assetFile.hpp"
+
+namespace CG {
+    void HotReloader::work() {
+        std::unique_lock lock(workMutex);
+        while (true) {
+            workSubmitted.wait(lock, [this]() {return (workPending || !running);});
+            if (!running) return;
+
+            workPending = false;
+            lock.unlock();
+            queue.execute();
+            lock.lock();
+        }
+    }
+
+    void HotReloader::rebuild(Shader &shader) {
+        shaderRebuilds.push_back({&shader, queue.create([path = shader.path, keywordMask = shader.keywordMask]() {
+            return Shader(path, keywordMask);
+        })});
+    }
+
+    void HotReloader::rebuild(const WatchedTexture &texture) {
+        textureRebuilds.push_back({texture.texture, queue.create([path = texture.path]() {
+            stbi_set_flip_vertically_on_load_thread(false); // Top row first, as 'Texture::setPixels' takes it
+
+            const AssetFile file(path);
+
+            int width, height, channels;
+            stbi_uc *const data = stbi_load_from_memory(reinterpret_cast<const stbi_uc *>(file.getBytes().data()), static_cast<int>(file.getSize()), &width, &height, &channels, 0);
+            if (data == nullptr) {
+                throw std::runtime_error("Failed to decode \"" + path.string() + "\": " + stbi_failure_reason() + '\n' + std::to_string(std::stacktrace::current()));
+            }
+
+            DecodedImage image;
+            image.width = static_cast<size_t>(width);
+            image.height = static_cast<size_t>(height);
+            image.channels = static_cast<size_t>(channels);
+            image.pixels.assign(data, (data + (image.width * image.height * image.channels)));
+            stbi_image_free(data);
+
+            return image;
+        })});
+    }
+
+    void HotReloader::finishRebuilds() {
+        const auto report = [this](const std::exception &exception) {
+            std::clog << "Hot reload failed, keeping the previous version:\n" << exception.what() << '\n';
+            ++failureCount;
+        };
+
+        // In submission order, so the latest edit of a file wins
+        for (size_t i = 0; i < shaderRebuilds.size();) {
+            if (!shaderRebuilds[i].result.isReady()) {
+                ++i;
+                continue;
+            }
+
+            ShaderRebuild rebuild = std::move(shaderRebuilds[i]);
+            shaderRebuilds.erase(shaderRebuilds.begin() + i);
+
+            try {
+                rebuild.target->adopt(rebuild.result.take());
+                ++reloadCount;
+            }
+            catch (const std::exception &exception) {
+                report(exception);
+            }
+        }
+
+        for (size_t i = 0; i < textureRebuilds.size();) {
+            if (!textureRebuilds[i].result.isReady()) {
+                ++i;
+                continue;
+            }
+
+            TextureRebuild rebuild = std::move(textureRebuilds[i]);
+            textureRebuilds.erase(textureRebuilds.begin() + i);
+
+            try {
+                const DecodedImage image = rebuild.result.take();
+                rebuild.target->setPixels(image.pixels, image.width, image.height, image.channels);
+                ++reloadCount;
+            }
+            catch (const std::exception &exception) {
+                report(exception);
+            }
+        }
+    }
+
+    HotReloader::HotReloader(const std::filesystem::path &root): watcher(root) {
+        worker = std::thread(&HotReloader::work, this);
+    }
+
+    void HotReloader::watch(Shader &shader) {
+        if (std::find(shaders.begin(), shaders.end(), &shader) == shaders.end()) shaders.push_back(&shader);
+    }
+
+    void HotReloader::watch(Texture &texture, const std::filesystem::path &path) {
+        textures.push_back({&texture, ShaderSources::normalize(path)});
+    }
+
+    void HotReloader::unwatch(const Shader &shader) {
+        std::erase(shaders, &shader);
+
+        // Variants are owned by the shader, so they go with it
+        const std::vector<Shader *> variants = shader.getVariants();
+        std::vector<const Shader *> owned(variants.begin(), variants.end());
+        owned.push_back(&shader);
+        std::erase_if(shaderRebuilds, [&](const ShaderRebuild &rebuild) {return (std::find(owned.begin(), owned.end(), rebuild.target) != owned.end());});
+    }
+
+    void HotReloader::unwatch(const Texture &texture) {
+        std::erase_if(textures, [&](const WatchedTexture &watched) {return (watched.texture == &texture);});
+        std::erase_if(textureRebuilds, [&](const TextureRebuild &rebuild) {return (rebuild.target == &texture);});
+    }
+
+    void HotReloader::update() {
+        const std::vector<std::filesystem::path> changes = watcher.takeChanges();
+
+        std::vector<Shader *> staleShaders;
+        for (const auto &path: changes) {
+            for (Shader *const shader: shaders) {
+                if (shader->dependsOn(path) && (std::find(staleShaders.begin(), staleShaders.end(), shader) == staleShaders.end())) staleShaders.push_back(shader);
+            }
+
+            for (const auto &texture: textures) {
+                if (texture.path == path) rebuild(texture);
+            }
+        }
+
+        for (Shader *const shader: staleShaders) {
+            rebuild(*shader);
+            for (Shader *const variant: shader->getVariants()) rebuild(*variant);
+        }
+
+        if (!changes.empty()) {
+            {
+                const std::lock_guard lock(workMutex);
+                workPending = true;
+            }
+            workSubmitted.notify_one();
+        }
+
+        finishRebuilds();
+    }
+
+    size_t HotReloader::getReloadCount() const noexcept {return reloadCount;}
+    size_t HotReloader::getFailureCount() const noexcept {return failureCount;}
+
+    HotReloader::~HotReloader() noexcept {
+        {
+            const std::lock_guard lock(workMutex);
+            running = false;
+        }
+        workSubmitted.notify_one();
+        worker.join();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <mutex>
+#include <condition_variable>
+#include "_cgControl.hpp"
+#include "fileWatcher.hpp"
+#include "resourceQueue.hpp"
+
+namespace CG {
+    class Shader;
+    class Texture;
+
+
+    // Rebuilds watched shaders and textures when their files change. Shaders compile and images decode on a background thread with its own
+    // shared context, then 'update' swaps the results in. A failed rebuild is reported on std::clog and the previous version stays.
+    // Watched objects must not move, and must outlive the reloader or be unwatched first.
+    class HotReloader {
+        private:
+            struct DecodedImage {
+                std::vector<uint8_t> pixels; // Top row first
+                size_t width = 0, height = 0, channels = 0;
+            };
+
+            struct WatchedTexture {
+                Texture *texture = nullptr;
+                std::filesystem::path path = ""; // Normalized
+            };
+
+            struct ShaderRebuild {
+                Shader *target = nullptr;
+                PendingResource<Shader> result;
+            };
+
+            struct TextureRebuild {
+                Texture *target = nullptr;
+                PendingResource<DecodedImage> result;
+            };
+
+            FileWatcher watcher;
+            ResourceQueue queue; // Executed by 'worker' only
+            std::mutex workMutex;
+            std::condition_variable workSubmitted;
+            bool workPending = false, running = true;
+            std::thread worker;
+
+            std::vector<Shader *> shaders;
+            std::vector<WatchedTexture> textures;
+            std::vector<ShaderRebuild> shaderRebuilds;
+            std::vector<TextureRebuild> textureRebuilds;
+            size_t reloadCount = 0, failureCount = 0;
+
+            void work();
+            void rebuild(Shader &shader);
+            void rebuild(const WatchedTexture &texture);
+            void finishRebuilds();
+
+        public:
+            explicit HotReloader(const std::filesystem::path &root = "assets"); // On the main thread, after the first window
+            HotReloader(const HotReloader &) = delete;
+
+            void watch(Shader &shader); // Its cached variants too
+            void watch(Texture &texture, const std::filesystem::path &path);
+            void unwatch(const Shader &shader);
+            void unwatch(const Texture &texture);
+
+            // Once a frame, with a context current and nothing else using the watched objects, ex.: at the start of a render callback.
+            // Swapped shaders keep their handles and uniform values, swapped textures keep their sampling state.
+            void update();
+
+            size_t getReloadCount() const noexcept;
+            size_t getFailureCount() const noexcept;
+
+            HotReloader &operator=(const HotReloader &) = delete;
+
+            ~HotReloader() noexcept;
+    };
+}
\ No newline at end of file
@@ -7,9 +7,11 @@ namespace CG {
     bool isGlfwInitialized() {return glfwInitialized;}
     bool isGladInitialized() {return gladInitialized;}
 
-    void initializeGlfw() {
+    void initializeGlfw(bool nullPlatform) {
         if (isGlfwInitialized()) return;
 
+        if (nullPlatform) glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+
         if (glfwInit() == GLFW_TRUE) [[likely]] {
             glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
             glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
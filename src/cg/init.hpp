@@ -5,6 +5,6 @@
 namespace CG {
     bool isGlfwInitialized();
     bool isGladInitialized();
-    void initializeGlfw();
+    void initializeGlfw(bool nullPlatform = false); // The null platform has no display, only EGL and OSMesa contexts
     void initializeGlad();
 }
\ No newline at end of file
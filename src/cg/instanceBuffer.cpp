@@ -0,0 +1,22 @@
+#include "instanceBuffer.hpp"
+
+namespace CG {
+    void Instance::enableInstanceAttributes(size_t offset) {
+        const auto attribute = [&](uint32_t location, size_t fieldOffset) {
+            glEnableVertexAttribArray(location);
+            glVertexAttribPointer(location, 4, GL_FLOAT, false, sizeof(Instance), std::bit_cast<const void *>(offset + fieldOffset));
+            glVertexAttribDivisor(location, 1);
+        };
+
+        for (uint32_t column = 0; column < 4; ++column) attribute((firstLocation + column), (offsetof(Instance, model) + (column * sizeof(Vector4))));
+        attribute((firstLocation + 4), offsetof(Instance, color));
+        attribute((firstLocation + 5), offsetof(Instance, uvTransform));
+    }
+
+    void Instance::disableInstanceAttributes() {
+        for (uint32_t location = firstLocation; location < (firstLocation + 6); ++location) {
+            glVertexAttribDivisor(location, 0);
+            glDisableVertexAttribArray(location);
+        }
+    }
+}
\ No newline at end of file
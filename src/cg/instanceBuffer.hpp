@@ -0,0 +1,88 @@
+#pragma once
+
+#include "_cgControl.hpp"
+#include "streamingBuffer.hpp"
+#include "mesh.hpp"
+
+namespace CG {
+    template<typename T>
+    concept validInstanceType =
+        std::is_trivially_copyable_v<T> &&
+        requires(size_t offset) {{T::enableInstanceAttributes(offset)} -> std::same_as<void>;} &&
+        requires() {{T::disableInstanceAttributes()} -> std::same_as<void>;}
+    ;
+
+
+    // Per instance attributes, advancing once per instance (divisor 1), right after 'Vertex's locations. In GLSL:
+    // layout (location = 3) in mat4 aModel; layout (location = 7) in vec4 aColor; layout (location = 8) in vec4 aUvTransform;
+    struct Instance {
+        static constexpr uint32_t firstLocation = 3;
+
+        static void enableInstanceAttributes(size_t offset); // Of the first instance in the bound GL_ARRAY_BUFFER
+        static void disableInstanceAttributes();
+
+        Matrix4 model = Matrix4::identity; // Takes 4 locations, one per column
+        Color color = Color::white;
+        Vector4 uvTransform = Vector4(1, 1, 0, 0); // Scale in xy, offset in zw
+    };
+
+
+    // Instance data rewritten every frame, streamed through a persistently mapped ring rather than reallocated
+    template<validInstanceType T>
+    class InstanceBuffer {
+        private:
+            StreamingBuffer stream;
+            size_t offset = 0;
+            size_t count = 0;
+
+        public:
+            static constexpr size_t defaultCapacity = 1024; // Instances per frame before the ring grows
+
+            explicit InstanceBuffer(size_t capacity = defaultCapacity);
+
+            void setData(std::span<const T> instances); // Once per frame, the previous frames' data stays untouched while the GPU may read it
+            size_t getCount() const noexcept;
+            const StreamingBuffer &getStream() const noexcept;
+            void bind() const;
+    };
+
+
+    template<validInstanceType T>
+    InstanceBuffer<T>::InstanceBuffer(size_t capacity): stream(capacity * sizeof(T)) {}
+
+    template<validInstanceType T>
+    void InstanceBuffer<T>::setData(std::span<const T> instances) {
+        stream.nextRegion();
+        count = instances.size();
+        if (instances.empty()) return;
+
+        const StreamingBuffer::Allocation allocation = stream.allocate(instances.size_bytes(), alignof(T));
+        std::memcpy(allocation.data, instances.data(), instances.size_bytes());
+        offset = allocation.offset;
+    }
+
+    template<validInstanceType T>
+    size_t InstanceBuffer<T>::getCount() const noexcept {return count;}
+
+    template<validInstanceType T>
+    const StreamingBuffer &InstanceBuffer<T>::getStream() const noexcept {return stream;}
+
+    template<validInstanceType T>
+    void InstanceBuffer<T>::bind() const {
+        glBindBuffer(GL_ARRAY_BUFFER, stream.getId());
+        T::enableInstanceAttributes(offset);
+    }
+
+
+    // One draw call for every instance, with the caller's shader bound
+    template<validInstanceType T>
+    void drawInstanced(const Mesh &mesh, const InstanceBuffer<T> &instances) {
+        if (instances.getCount() == 0) return;
+
+        mesh.bind();
+        instances.bind();
+        glDrawElementsInstanced(GL_TRIANGLES, mesh.getIndexCount(), mesh.getIndexType(), nullptr, instances.getCount());
+
+        T::disableInstanceAttributes(); // So non instanced draws don't inherit the divisors
+    }
+}
\ No newline at end of file
@@ -0,0 +1,408 @@
+#include "jobSystem.hpp"
+#include "profiler.hpp"
+#include "frameArena.hpp"
+
+namespace CG {
+    struct Job {
+        JobFunction function;
+        JobCounter *signal = nullptr;
+    };
+
+    namespace {
+        thread_local JobDeque *currentDeque = nullptr; // Of the worker running on this thread
+        thread_local size_t jobDepth = 0; // Jobs run inline by a job's 'wait' nest
+
+        // Recycled jobs, allocated in blocks. Each thread keeps a few at hand and trades them with the shared list in batches,
+        // as jobs are usually created on one thread and finished on another.
+        class JobPool {
+            private:
+                static constexpr size_t blockSize = 256, batchSize = 16;
+
+                struct ThreadCache {
+                    std::vector<Job *> jobs;
+
+                    ~ThreadCache() noexcept; // Hands its jobs back, so threads coming and going don't drain the pool
+                };
+
+                static std::mutex mutex;
+                static std::vector<std::unique_ptr<Job[]>> blocks;
+                static std::vector<Job *> freeJobs;
+                static thread_local ThreadCache cache;
+
+            public:
+                static Job *acquire();
+                static void release(Job *job) noexcept;
+        };
+
+        std::mutex JobPool::mutex;
+        std::vector<std::unique_ptr<Job[]>> JobPool::blocks = {};
+        std::vector<Job *> JobPool::freeJobs = {};
+        thread_local JobPool::ThreadCache JobPool::cache = {};
+
+        JobPool::ThreadCache::~ThreadCache() noexcept {
+            const std::lock_guard lock(mutex);
+            freeJobs.insert(freeJobs.end(), jobs.begin(), jobs.end());
+        }
+
+        Job *JobPool::acquire() {
+            if (cache.jobs.empty()) {
+                const std::lock_guard lock(mutex);
+                if (freeJobs.empty()) {
+                    blocks.push_back(std::make_unique<Job[]>(blockSize));
+                    freeJobs.reserve(blocks.size() * blockSize); // Room for every job, so handing batches back never reallocates
+                    for (size_t i = 0; i < blockSize; ++i) freeJobs.push_back(&blocks.back()[i]);
+                }
+
+                const size_t count = std::min(batchSize, freeJobs.size());
+                cache.jobs.insert(cache.jobs.end(), (freeJobs.end() - count), freeJobs.end());
+                freeJobs.resize(freeJobs.size() - count);
+            }
+
+            Job *const job = cache.jobs.back();
+            cache.jobs.pop_back();
+            return job;
+        }
+
+        void JobPool::release(Job *job) noexcept {
+            job->function = {};
+            job->signal = nullptr;
+
+            // Capacity for two batches is reserved up front, so this never allocates past a thread's first release
+            if (cache.jobs.capacity() < (2 * batchSize)) cache.jobs.reserve(2 * batchSize);
+            cache.jobs.push_back(job);
+            if (cache.jobs.size() < (2 * batchSize)) return;
+
+            const std::lock_guard lock(mutex);
+            freeJobs.insert(freeJobs.end(), (cache.jobs.end() - batchSize), cache.jobs.end());
+            cache.jobs.resize(cache.jobs.size() - batchSize);
+        }
+    }
+
+
+    void JobFunction::moveFrom(JobFunction &other) noexcept {
+        if (other.relocator != nullptr) other.relocator(other.storage, storage);
+        invoker = other.invoker;
+        relocator = other.relocator;
+
+        other.invoker = nullptr;
+        other.relocator = nullptr;
+    }
+
+    void JobFunction::destroy() noexcept {
+        if (relocator != nullptr) relocator(storage, nullptr);
+        invoker = nullptr;
+        relocator = nullptr;
+    }
+
+    JobFunction::JobFunction(JobFunction &&other) noexcept {
+        this->moveFrom(other);
+    }
+
+    void JobFunction::operator()() {
+        ASSERT(invoker != nullptr);
+        invoker(storage);
+    }
+
+    JobFunction::operator bool() const noexcept {return (invoker != nullptr);}
+
+    JobFunction &JobFunction::operator=(JobFunction &&other) noexcept {
+        if (this != &other) {
+            destroy();
+            this->moveFrom(other);
+        }
+        return (*this);
+    }
+
+    JobFunction::~JobFunction() noexcept {destroy();}
+
+
+    void JobCounter::increment(uint32_t count) noexcept {
+        pending.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    void JobCounter::decrement() {
+        // Locked throughout, so a waiter that saw zero can lock it once to know this thread is done with the counter
+        std::vector<Job *> ready;
+        {
+            const std::lock_guard lock(continuationsMutex);
+            if (pending.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+            ready.swap(continuations);
+        }
+        for (Job *const job: ready) JobSystem::schedule(job);
+    }
+
+    bool JobCounter::isDone() const noexcept {return (pending.load(std::memory_order_acquire) == 0);}
+    uint32_t JobCounter::getPending() const noexcept {return pending.load(std::memory_order_acquire);}
+
+
+    bool JobDeque::push(Job *job) noexcept {
+        const int64_t b = bottom.load(std::memory_order_relaxed);
+        const int64_t t = top.load(std::memory_order_acquire);
+        if ((b - t) >= static_cast<int64_t>(capacity)) return false;
+
+        buffer[b & (capacity - 1)].store(job, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store((b + 1), std::memory_order_relaxed);
+        return true;
+    }
+
+    Job *JobDeque::pop() noexcept {
+        const int64_t b = (bottom.load(std::memory_order_relaxed) - 1);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            bottom.store((b + 1), std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        Job *job = buffer[b & (capacity - 1)].load(std::memory_order_relaxed);
+        if (t == b) {
+            // Last one, a thief may be taking it at the same time
+            if (!top.compare_exchange_strong(t, (t + 1), std::memory_order_seq_cst, std::memory_order_relaxed)) job = nullptr;
+            bottom.store((b + 1), std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    Job *JobDeque::steal() noexcept {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b) return nullptr;
+
+        Job *const job = buffer[t & (capacity - 1)].load(std::memory_order_relaxed);
+        if (!top.compare_exchange_strong(t, (t + 1), std::memory_order_seq_cst, std::memory_order_relaxed)) return nullptr;
+        return job;
+    }
+
+    size_t JobDeque::getSize() const noexcept {
+        return static_cast<size_t>(std::max<int64_t>((bottom.load(std::memory_order_relaxed) - top.load(std::memory_order_relaxed)), 0));
+    }
+
+
+    void JobSystem::JobQueue::push(Job *job) {
+        // Reuses the consumed front before growing, without reallocating
+        if ((head > 0) && (jobs.size() == jobs.capacity())) {
+            jobs.erase(jobs.begin(), (jobs.begin() + head));
+            head = 0;
+        }
+        jobs.push_back(job);
+    }
+
+    Job *JobSystem::JobQueue::pop() noexcept {
+        if (head == jobs.size()) return nullptr;
+
+        Job *const job = jobs[head++];
+        if (head == jobs.size()) {
+            jobs.clear();
+            head = 0;
+        }
+        return job;
+    }
+
+    size_t JobSystem::JobQueue::getSize() const noexcept {return (jobs.size() - head);}
+
+
+    std::vector<JobSystem::Worker> JobSystem::workers = {};
+    std::mutex JobSystem::injectedMutex;
+    JobSystem::JobQueue JobSystem::injected = {};
+    std::mutex JobSystem::mainThreadMutex;
+    JobSystem::JobQueue JobSystem::mainThreadJobs = {};
+    std::thread::id JobSystem::mainThreadId = std::this_thread::get_id();
+    std::mutex JobSystem::sleepMutex;
+    std::condition_variable JobSystem::wake;
+    std::atomic<size_t> JobSystem::queuedCount = 0;
+    std::atomic<bool> JobSystem::stopping = false;
+    std::atomic<size_t> JobSystem::executedCount = 0, JobSystem::stolenCount = 0;
+
+    void JobSystem::schedule(Job *job) {
+        // Without workers everything runs inline, so single threaded builds behave the same
+        if (workers.empty()) {
+            execute(job);
+            return;
+        }
+
+        queuedCount.fetch_add(1, std::memory_order_release);
+        if ((currentDeque == nullptr) || !currentDeque->push(job)) {
+            const std::lock_guard lock(injectedMutex);
+            injected.push(job);
+        }
+
+        {
+            const std::lock_guard lock(sleepMutex); // Pairs with the workers' check, so the notification can't slip in between
+        }
+        wake.notify_one();
+    }
+
+    void JobSystem::execute(Job *job) {
+        {
+            CG_PROFILE_ZONE("Job");
+            ++jobDepth;
+            job->function();
+            --jobDepth;
+        }
+
+        // A worker's arena only lives as long as its outermost job
+        if ((currentDeque != nullptr) && (jobDepth == 0)) FrameArena::getThread().reset();
+
+        JobCounter *const signal = job->signal;
+        JobPool::release(job);
+        executedCount.fetch_add(1, std::memory_order_relaxed);
+        if (signal != nullptr) signal->decrement();
+    }
+
+    Job *JobSystem::findJob() {
+        if (currentDeque != nullptr) {
+            if (Job *const job = currentDeque->pop()) return job;
+        }
+
+        {
+            const std::lock_guard lock(injectedMutex);
+            if (Job *const job = injected.pop()) return job;
+        }
+
+        // Starting from a different victim per thread spreads the thieves out
+        static thread_local size_t victim = std::hash<std::thread::id>()(std::this_thread::get_id());
+        for (size_t i = 0; i < workers.size(); ++i) {
+            JobDeque &deque = *workers[(victim + i) % workers.size()].deque;
+            if (&deque == currentDeque) continue;
+
+            if (Job *const job = deque.steal()) {
+                victim += i;
+                stolenCount.fetch_add(1, std::memory_order_relaxed);
+                return job;
+            }
+        }
+        return nullptr;
+    }
+
+    bool JobSystem::runOne() {
+        Job *const job = findJob();
+        if (job == nullptr) return false;
+
+        queuedCount.fetch_sub(1, std::memory_order_acq_rel);
+        execute(job);
+        return true;
+    }
+
+    void JobSystem::workerLoop(size_t index) {
+        currentDeque = workers[index].deque.get();
+
+        while (true) {
+            if (runOne()) continue;
+
+            std::unique_lock lock(sleepMutex);
+            if (stopping.load(std::memory_order_acquire) && (queuedCount.load(std::memory_order_acquire) == 0)) break;
+            wake.wait(lock, []() {return (stopping.load(std::memory_order_acquire) || (queuedCount.load(std::memory_order_acquire) > 0));});
+        }
+
+        currentDeque = nullptr;
+    }
+
+    void JobSystem::start(size_t workerCount) {
+        ASSERT(!isRunning());
+
+        mainThreadId = std::this_thread::get_id();
+        stopping = false;
+
+        // Deques exist before any thread starts, so thieves can index every worker
+        workers.resize(workerCount);
+        for (size_t i = 0; i < workerCount; ++i) workers[i].thread = std::jthread(workerLoop, i);
+    }
+
+    void JobSystem::stop() {
+        {
+            const std::lock_guard lock(sleepMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+
+        for (Worker &worker: workers) {
+            if (worker.thread.joinable()) worker.thread.join();
+        }
+        workers.clear();
+    }
+
+    bool JobSystem::isRunning() noexcept {return !workers.empty();}
+    size_t JobSystem::getWorkerCount() noexcept {return workers.size();}
+    size_t JobSystem::getDefaultWorkerCount() noexcept {return std::max(std::thread::hardware_concurrency(), 2u) - 1;}
+    bool JobSystem::isMainThread() noexcept {return (std::this_thread::get_id() == mainThreadId);}
+
+    void JobSystem::run(JobFunction function, JobCounter *signal, JobCounter *dependency) {
+        Job *const job = JobPool::acquire();
+        job->function = std::move(function);
+        job->signal = signal;
+        if (signal != nullptr) signal->increment();
+
+        if (dependency != nullptr) {
+            const std::lock_guard lock(dependency->continuationsMutex);
+            if (!dependency->isDone()) {
+                dependency->continuations.push_back(job);
+                return;
+            }
+        }
+
+        schedule(job);
+    }
+
+    void JobSystem::runOnMainThread(JobFunction function, JobCounter *signal) {
+        Job *const job = JobPool::acquire();
+        job->function = std::move(function);
+        job->signal = signal;
+        if (signal != nullptr) signal->increment();
+
+        const std::lock_guard lock(mainThreadMutex);
+        mainThreadJobs.push(job);
+    }
+
+    void JobSystem::executeMainThreadJobs() {
+        ASSERT(isMainThread());
+
+        // Only the jobs queued so far, the ones they queue wait for the next call. Taken one at a time, as a job's 'wait' may run some of them first.
+        size_t remaining = 0;
+        {
+            const std::lock_guard lock(mainThreadMutex);
+            remaining = mainThreadJobs.getSize();
+        }
+
+        for (; remaining > 0; --remaining) {
+            Job *job = nullptr;
+            {
+                const std::lock_guard lock(mainThreadMutex);
+                job = mainThreadJobs.pop();
+            }
+            if (job == nullptr) break;
+            execute(job);
+        }
+    }
+
+    void JobSystem::wait(const JobCounter &counter) {
+        const bool mainThread = isMainThread();
+        while (!counter.isDone()) {
+            if (mainThread) executeMainThreadJobs();
+            if (!runOne()) std::this_thread::yield();
+        }
+
+        const std::lock_guard lock(counter.continuationsMutex); // The last decrement may still be unlocking, the caller can destroy the counter after this
+    }
+
+    void JobSystem::parallelForInternal(size_t count, FunctionRef<void(size_t, size_t)> function, size_t grainSize) {
+        if (count == 0) return;
+        if (grainSize == automaticGrainSize) grainSize = std::max<size_t>((count / ((getWorkerCount() + 1) * 4)), 1);
+
+        // The caller takes the first chunk itself rather than idling in 'wait'
+        JobCounter counter;
+        for (size_t begin = grainSize; begin < count; begin += grainSize) {
+            const size_t end = std::min((begin + grainSize), count);
+            run([function, begin, end]() {function(begin, end);}, &counter);
+        }
+
+        function(0, std::min(grainSize, count));
+        wait(counter);
+    }
+
+    size_t JobSystem::getExecutedCount() noexcept {return executedCount.load(std::memory_order_relaxed);}
+    size_t JobSystem::getStolenCount() noexcept {return stolenCount.load(std::memory_order_relaxed);}
+}
\ No newline at end of file
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <new>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include "_cgControl.hpp"
+#include "functionRef.hpp"
+
+namespace CG {
+    struct Job;
+
+
+    // Owning 'void()' callable for jobs. Kept inline when it fits, ex.: a lambda capturing a few references and indices, so scheduling it never allocates.
+    // Bigger ones go to the heap, like 'std::function' would.
+    class JobFunction {
+        private:
+            static constexpr size_t inlineSize = 48;
+
+            alignas(std::max_align_t) std::byte storage[inlineSize];
+            void (*invoker)(void *storage) = nullptr;
+            void (*relocator)(void *source, void *destination) noexcept = nullptr; // Moves into 'destination' if not null, then destroys 'source'
+
+            template<typename F> static constexpr bool fitsInline = ((sizeof(F) <= inlineSize) && (alignof(F) <= alignof(std::max_align_t)) && std::is_nothrow_move_constructible_v<F>);
+
+            void moveFrom(JobFunction &other) noexcept;
+            void destroy() noexcept;
+
+        public:
+            JobFunction() noexcept = default;
+            JobFunction(const JobFunction &) = delete;
+            JobFunction(JobFunction &&other) noexcept;
+
+            template<typename F> requires (!std::is_same_v<std::remove_cvref_t<F>, JobFunction> && std::is_invocable_v<std::decay_t<F> &>)
+            JobFunction(F &&function);
+
+            void operator()();
+            explicit operator bool() const noexcept;
+
+            JobFunction &operator=(const JobFunction &) = delete;
+            JobFunction &operator=(JobFunction &&other) noexcept;
+
+            ~JobFunction() noexcept;
+    };
+
+
+    // Jobs left to finish. Waiting on it helps run other jobs instead of blocking, and jobs can depend on it to only start once it reaches zero.
+    // Destroy it only after 'JobSystem::wait' returned, 'isDone' alone doesn't mean the last job let go of it.
+    class JobCounter {
+        friend class JobSystem;
+
+        private:
+            std::atomic<uint32_t> pending = 0;
+            mutable std::mutex continuationsMutex;
+            std::vector<Job *> continuations; // Scheduled once 'pending' reaches zero
+
+            void increment(uint32_t count = 1) noexcept;
+            void decrement();
+
+        public:
+            JobCounter() = default;
+            JobCounter(const JobCounter &) = delete;
+
+            bool isDone() const noexcept;
+            uint32_t getPending() const noexcept;
+
+            JobCounter &operator=(const JobCounter &) = delete;
+    };
+
+
+    // Chase-Lev deque of one worker: the owner pushes and pops at the bottom, other threads steal from the top
+    class JobDeque {
+        private:
+            static constexpr size_t capacity = 4096; // Power of two, pushing past it fails and the caller runs the job inline
+
+            std::atomic<int64_t> top = 0, bottom = 0;
+            std::array<std::atomic<Job *>, capacity> buffer;
+
+        public:
+            JobDeque() = default;
+            JobDeque(const JobDeque &) = delete;
+
+            bool push(Job *job) noexcept; // Owner only
+            Job *pop() noexcept;          // Owner only
+            Job *steal() noexcept;        // Any thread
+            size_t getSize() const noexcept;
+
+            JobDeque &operator=(const JobDeque &) = delete;
+    };
+
+
+    // Work stealing thread pool. Workers own a deque each, threads that aren't workers submit through a shared queue.
+    // Jobs meant for GL go to the main thread queue, run by 'executeMainThreadJobs' (the 'Application' does it every frame) and by the main thread's waits.
+    class JobSystem {
+        friend class JobCounter;
+
+        private:
+            struct Worker {
+                std::unique_ptr<JobDeque> deque = std::make_unique<JobDeque>();
+                std::jthread thread;
+            };
+
+            // First in, first out over a vector that keeps its capacity, unlike 'std::deque' which allocates blocks as it goes. Locked by the owner.
+            struct JobQueue {
+                std::vector<Job *> jobs;
+                size_t head = 0;
+
+                void push(Job *job);
+                Job *pop() noexcept; // Null when empty
+                size_t getSize() const noexcept;
+            };
+
+            static std::vector<Worker> workers;
+            static std::mutex injectedMutex;
+            static JobQueue injected; // From threads without a deque
+            static std::mutex mainThreadMutex;
+            static JobQueue mainThreadJobs;
+            static std::thread::id mainThreadId;
+            static std::mutex sleepMutex;
+            static std::condition_variable wake;
+            static std::atomic<size_t> queuedCount; // In deques and the injected queue, workers sleep while it's zero
+            static std::atomic<bool> stopping;
+            static std::atomic<size_t> executedCount, stolenCount;
+
+            static void schedule(Job *job);
+            static void execute(Job *job);
+            static Job *findJob();
+            static bool runOne(); // False when nothing was found
+            static void workerLoop(size_t index);
+            static void parallelForInternal(size_t count, FunctionRef<void(size_t, size_t)> function, size_t grainSize);
+
+        public:
+            static constexpr size_t automaticGrainSize = 0;
+
+            static void start(size_t workerCount = getDefaultWorkerCount()); // The calling thread becomes the main thread
+            static void stop(); // Finishes the queued jobs first. Call before leaving 'main', workers don't outlive it on their own.
+            static bool isRunning() noexcept;
+            static size_t getWorkerCount() noexcept;
+            static size_t getDefaultWorkerCount() noexcept; // One per core, minus the main thread's
+            static bool isMainThread() noexcept;
+
+            // 'signal' is incremented now and decremented once the job ran. With 'dependency', the job only starts once that counter is done.
+            // Jobs come from a pool, so past its growth running one doesn't allocate unless 'function' is too big to be kept inline.
+            static void run(JobFunction function, JobCounter *signal = nullptr, JobCounter *dependency = nullptr);
+            static void runOnMainThread(JobFunction function, JobCounter *signal = nullptr);
+            static void executeMainThreadJobs(); // On the main thread
+
+            static void wait(const JobCounter &counter); // Runs other jobs meanwhile, main thread jobs too when called from it
+
+            // 'function(begin, end)' over [0, count) in chunks of 'grainSize', a few per thread when automatic. Returns once every chunk ran.
+            // Chunks refer to 'function' rather than copying it, so a warmed up pool runs it without allocating.
+            template<typename Function> static void parallelFor(size_t count, Function &&function, size_t grainSize = automaticGrainSize);
+
+            static size_t getExecutedCount() noexcept;
+            static size_t getStolenCount() noexcept; // Jobs a worker took from another one's deque
+    };
+
+
+    template<typename F> requires (!std::is_same_v<std::remove_cvref_t<F>, JobFunction> && std::is_invocable_v<std::decay_t<F> &>)
+    JobFunction::JobFunction(F &&function) {
+        using Callable = std::decay_t<F>;
+
+        if constexpr (fitsInline<Callable>) {
+            new (storage) Callable(std::forward<F>(function));
+            invoker = [](void *storage) {(*std::launder(static_cast<Callable *>(storage)))();};
+            relocator = [](void *source, void *destination) noexcept {
+                Callable &callable = *std::launder(static_cast<Callable *>(source));
+                if (destination != nullptr) new (destination) Callable(std::move(callable));
+                callable.~Callable();
+            };
+        }
+        else {
+            new (storage) Callable *(new Callable(std::forward<F>(function)));
+            invoker = [](void *storage) {(**std::launder(static_cast<Callable **>(storage)))();};
+            relocator = [](void *source, void *destination) noexcept {
+                Callable *const callable = *std::launder(static_cast<Callable **>(source));
+                if (destination != nullptr) new (destination) Callable *(callable);
+                else delete callable;
+            };
+        }
+    }
+
+    template<typename Function>
+    void JobSystem::parallelFor(size_t count, Function &&function, size_t grainSize) {
+        parallelForInternal(count, FunctionRef<void(size_t, size_t)>(function), grainSize);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,16 @@
+#include "mesh.hpp"
+
+namespace CG {
+    void Mesh::bind() const {
+        vertices.bind();
+        indices.bind();
+    }
+
+    void Mesh::draw() const {
+        bind();
+        glDrawElements(GL_TRIANGLES, indexCount, indexType, nullptr);
+    }
+
+    size_t Mesh::getIndexCount() const noexcept {return indexCount;}
+    GLenum Mesh::getIndexType() const noexcept {return indexType;}
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "_cgControl.hpp"
+#include "vertexBuffer.hpp"
+#include "indexBuffer.hpp"
+
+namespace CG {
+    // Vertices and the triangle list indexing them
+    class Mesh {
+        private:
+            VertexBuffer vertices;
+            IndexBuffer indices;
+            size_t indexCount = 0;
+            GLenum indexType = GL_UNSIGNED_INT;
+
+        public:
+            Mesh() = delete;
+            template<validVertexType T> Mesh(const std::vector<T> &vertices, const IndexList &indices, DrawMode drawMode = DrawMode::Static);
+
+            void bind() const;
+            void draw() const;
+            size_t getIndexCount() const noexcept;
+            GLenum getIndexType() const noexcept;
+    };
+
+
+    template<validVertexType T>
+    Mesh::Mesh(const std::vector<T> &vertices, const IndexList &indices, DrawMode drawMode):
+        vertices(vertices, drawMode), indices(indices, drawMode), indexCount(indices.getCount()), indexType(static_cast<GLenum>(indices.getTypeEnum())) {}
+}
\ No newline at end of file
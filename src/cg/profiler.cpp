@@ -0,0 +1,264 @@
+#include <numeric>
+#include <sstream>
+#include "profiler.hpp"
+#include "window.hpp"
+
+namespace CG {
+    ProfileTrack::ProfileTrack(std::string_view name, bool gpu, size_t capacity): name(name), gpu(gpu), records(capacity) {}
+
+    void ProfileTrack::push(const ProfileRecord &record) {
+        const std::lock_guard lock(mutex);
+        records[next] = record;
+        next = ((next + 1) % records.size());
+        count = std::min((count + 1), records.size());
+    }
+
+    std::string_view ProfileTrack::getName() const noexcept {return name;}
+    bool ProfileTrack::isGpu() const noexcept {return gpu;}
+
+
+    std::atomic<bool> Profiler::enabled = false;
+    std::mutex Profiler::tracksMutex;
+    std::vector<std::unique_ptr<ProfileTrack>> Profiler::tracks = {};
+
+    void Profiler::forEachRecord(const std::function<void(const ProfileTrack &, const ProfileRecord &)> &function) {
+        const std::lock_guard tracksLock(tracksMutex);
+        for (const auto &track: tracks) {
+            const std::lock_guard lock(track->mutex);
+
+            // Oldest first
+            const size_t capacity = track->records.size();
+            for (size_t i = 0; i < track->count; ++i) function(*track, track->records[(track->next + capacity - track->count + i) % capacity]);
+        }
+    }
+
+    bool Profiler::isEnabled() noexcept {return enabled.load(std::memory_order_relaxed);}
+    void Profiler::setEnabled(bool value) noexcept {enabled.store(value, std::memory_order_relaxed);}
+
+    int64_t Profiler::now() noexcept {
+        static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    ProfileTrack &Profiler::getThreadTrack() {
+        thread_local ProfileTrack *track = nullptr;
+        if (track == nullptr) {
+            std::ostringstream name;
+            name << "Thread " << std::this_thread::get_id();
+            track = &createTrack(name.str(), false);
+        }
+        return *track;
+    }
+
+    ProfileTrack &Profiler::createTrack(std::string_view name, bool gpu) {
+        const std::lock_guard lock(tracksMutex);
+        tracks.push_back(std::make_unique<ProfileTrack>(name, gpu, trackCapacity));
+        return *tracks.back();
+    }
+
+    ProfileStats Profiler::getStats(std::string_view zoneName, bool gpu) {
+        std::vector<float64_t> durations;
+        forEachRecord([&](const ProfileTrack &track, const ProfileRecord &record) {
+            if ((track.isGpu() == gpu) && (zoneName == record.name)) durations.push_back(static_cast<float64_t>(record.end - record.start) / 1e6);
+        });
+
+        // Records arrive oldest first per track, the tail is the rolling window
+        if (durations.size() > statsSampleCount) durations.erase(durations.begin(), (durations.end() - statsSampleCount));
+
+        ProfileStats result;
+        result.count = durations.size();
+        if (durations.empty()) return result;
+
+        const auto [minimum, maximum] = std::minmax_element(durations.begin(), durations.end());
+        result.min = *minimum;
+        result.max = *maximum;
+        result.average = (std::accumulate(durations.begin(), durations.end(), 0.0) / durations.size());
+
+        const size_t p99Index = static_cast<size_t>(std::ceil(0.99 * durations.size())) - 1;
+        std::nth_element(durations.begin(), (durations.begin() + p99Index), durations.end());
+        result.p99 = durations[p99Index];
+
+        return result;
+    }
+
+    std::string Profiler::formatStats() {
+        std::vector<std::pair<bool, std::string_view>> zones;
+        forEachRecord([&](const ProfileTrack &track, const ProfileRecord &record) {
+            const std::pair<bool, std::string_view> zone = {track.isGpu(), record.name};
+            if (std::find(zones.begin(), zones.end(), zone) == zones.end()) zones.push_back(zone);
+        });
+        std::sort(zones.begin(), zones.end());
+
+        std::string result;
+        for (const auto &[gpu, name]: zones) {
+            const ProfileStats stats = getStats(name, gpu);
+            result += std::format("{} {}: min {:.3f} avg {:.3f} p99 {:.3f} max {:.3f} ms ({})\n", (gpu? "GPU":"CPU"), name, stats.min, stats.average, stats.p99, stats.max, stats.count);
+        }
+        return result;
+    }
+
+    void Profiler::writeChromeTrace(const std::filesystem::path &path) {
+        const auto escape = [](std::string_view text) {
+            std::string result;
+            for (const char c: text) {
+                if ((c == '"') || (c == '\\')) result += '\\';
+                result += c;
+            }
+            return result;
+        };
+
+        std::ofstream file(path);
+        if (!file) throw std::runtime_error("Failed to open \"" + path.string() + "\":\n" + std::to_string(std::stacktrace::current()));
+
+        file << "{\"traceEvents\":[\n";
+        bool first = true;
+
+        std::vector<const ProfileTrack *> seenTracks;
+        forEachRecord([&](const ProfileTrack &track, const ProfileRecord &record) {
+            auto trackIter = std::find(seenTracks.begin(), seenTracks.end(), &track);
+            const size_t trackIndex = static_cast<size_t>(trackIter - seenTracks.begin());
+            if (trackIter == seenTracks.end()) {
+                seenTracks.push_back(&track);
+                file << (first? "":",\n") << std::format(R"({{"name":"thread_name","ph":"M","pid":1,"tid":{},"args":{{"name":"{}"}}}})", trackIndex, escape(track.getName()));
+                first = false;
+            }
+
+            file << (first? "":",\n") << std::format(R"({{"name":"{}","ph":"X","pid":1,"tid":{},"ts":{:.3f},"dur":{:.3f}}})",
+                escape(record.name), trackIndex, (static_cast<float64_t>(record.start) / 1e3), (static_cast<float64_t>(record.end - record.start) / 1e3));
+            first = false;
+        });
+
+        file << "\n]}\n";
+    }
+
+    void Profiler::clear() {
+        const std::lock_guard tracksLock(tracksMutex);
+        for (const auto &track: tracks) {
+            const std::lock_guard lock(track->mutex);
+            track->next = 0;
+            track->count = 0;
+        }
+    }
+
+
+    ProfileZone::ProfileZone(const char *name): name(name) {
+        if (!Profiler::isEnabled()) return;
+
+        track = &Profiler::getThreadTrack();
+        depth = track->depth++;
+        start = Profiler::now();
+    }
+
+    ProfileZone::~ProfileZone() noexcept {
+        if (track == nullptr) return;
+
+        const int64_t end = Profiler::now();
+        --track->depth;
+        track->push({name, start, end, depth});
+    }
+
+
+    uint32_t GpuTimerPool::acquireQuery() {
+        if (freeQueries.empty()) {
+            uint32_t query;
+            glGenQueries(1, &query);
+            return query;
+        }
+
+        const uint32_t query = freeQueries.back();
+        freeQueries.pop_back();
+        return query;
+    }
+
+    void GpuTimerPool::calibrate() {
+        GLint64 gpuNow;
+        glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+        gpuToCpuOffset = (Profiler::now() - gpuNow);
+    }
+
+    void GpuTimerPool::collect(std::vector<Zone> &zones) {
+        if (zones.empty()) return;
+
+        // Outer zones end last, so every end query is checked rather than the last one begun
+        bool available = true;
+        for (const auto &zone: zones) {
+            GLint zoneAvailable = GL_FALSE;
+            if (zone.endQuery != 0) glGetQueryObjectiv(zone.endQuery, GL_QUERY_RESULT_AVAILABLE, &zoneAvailable);
+            available = (available && (zoneAvailable == GL_TRUE));
+        }
+
+        for (const auto &zone: zones) {
+            if (available) {
+                GLuint64 begin, end;
+                glGetQueryObjectui64v(zone.beginQuery, GL_QUERY_RESULT, &begin);
+                glGetQueryObjectui64v(zone.endQuery, GL_QUERY_RESULT, &end);
+                track.push({zone.name, (static_cast<int64_t>(begin) + gpuToCpuOffset), (static_cast<int64_t>(end) + gpuToCpuOffset), zone.depth});
+            }
+
+            freeQueries.push_back(zone.beginQuery);
+            if (zone.endQuery != 0) freeQueries.push_back(zone.endQuery);
+        }
+
+        if (!available) ++droppedFrameCount;
+        zones.clear();
+    }
+
+    GpuTimerPool::GpuTimerPool(std::string_view trackName): track(Profiler::createTrack(trackName, true)) {
+        calibrate();
+    }
+
+    void GpuTimerPool::beginFrame() {
+        ++frameIndex;
+        if ((frameIndex % 256) == 0) calibrate(); // The clocks drift apart slowly
+
+        collect(frames[frameIndex % latency]);
+    }
+
+    size_t GpuTimerPool::begin(const char *name) {
+        std::vector<Zone> &zones = frames[frameIndex % latency];
+
+        Zone zone;
+        zone.name = name;
+        zone.beginQuery = acquireQuery();
+        zone.depth = track.depth++;
+        glQueryCounter(zone.beginQuery, GL_TIMESTAMP);
+
+        zones.push_back(zone);
+        return (zones.size() - 1);
+    }
+
+    void GpuTimerPool::end(size_t zone) {
+        Zone &z = frames[frameIndex % latency][zone];
+        z.endQuery = acquireQuery();
+        glQueryCounter(z.endQuery, GL_TIMESTAMP);
+        --track.depth;
+    }
+
+    size_t GpuTimerPool::getDroppedFrameCount() const noexcept {return droppedFrameCount;}
+
+    GpuTimerPool::~GpuTimerPool() noexcept {
+        // Queries still in flight included, their results are dropped
+        for (const auto &zones: frames) {
+            for (const auto &zone: zones) {
+                glDeleteQueries(1, &zone.beginQuery);
+                glDeleteQueries(1, &zone.endQuery); // 0 when the zone never ended, ignored
+            }
+        }
+        glDeleteQueries(static_cast<GLsizei>(freeQueries.size()), freeQueries.data());
+    }
+
+
+    GpuProfileZone::GpuProfileZone(const char *name) {
+        if (!Profiler::isEnabled()) return;
+
+        const Window *const window = Window::getCurrentContext();
+        if ((window == nullptr) || (window->getGpuTimers() == nullptr)) return;
+
+        pool = window->getGpuTimers();
+        zone = pool->begin(name);
+    }
+
+    GpuProfileZone::~GpuProfileZone() noexcept {
+        if (pool != nullptr) pool->end(zone);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include "_cgControl.hpp"
+
+#define CG_PROFILE_CONCATENATE_INNER(a, b) a##b
+#define CG_PROFILE_CONCATENATE(a, b) CG_PROFILE_CONCATENATE_INNER(a, b)
+
+// Names must outlive the profiler (string literals), they aren't copied
+#define CG_PROFILE_ZONE(name) const CG::ProfileZone CG_PROFILE_CONCATENATE(profileZone, __LINE__)(name)
+#define CG_PROFILE_GPU_ZONE(name) const CG::GpuProfileZone CG_PROFILE_CONCATENATE(gpuProfileZone, __LINE__)(name)
+
+namespace CG {
+    struct ProfileRecord {
+        const char *name = nullptr;
+        int64_t start = 0, end = 0; // Nanoseconds since 'Profiler::now' started counting
+        uint32_t depth = 0;
+    };
+
+    struct ProfileStats {
+        size_t count = 0;
+        float64_t min = 0.0, average = 0.0, p99 = 0.0, max = 0.0; // Milliseconds
+    };
+
+
+    // Ring of the latest records of one thread, or of one context's GPU timeline
+    class ProfileTrack {
+        friend class Profiler;
+
+        private:
+            std::string name;
+            bool gpu = false;
+            mutable std::mutex mutex; // Uncontended unless stats or an export read it
+            std::vector<ProfileRecord> records;
+            size_t next = 0;
+            size_t count = 0;
+
+        public:
+            uint32_t depth = 0; // Open zones, only touched by the writer
+
+            ProfileTrack(std::string_view name, bool gpu, size_t capacity);
+            ProfileTrack(const ProfileTrack &) = delete;
+
+            void push(const ProfileRecord &record);
+            std::string_view getName() const noexcept;
+            bool isGpu() const noexcept;
+
+            ProfileTrack &operator=(const ProfileTrack &) = delete;
+    };
+
+
+    class Profiler {
+        private:
+            static std::atomic<bool> enabled;
+            static std::mutex tracksMutex;
+            static std::vector<std::unique_ptr<ProfileTrack>> tracks; // Never shrinks while zones may still point at them
+
+            static void forEachRecord(const std::function<void(const ProfileTrack &, const ProfileRecord &)> &function);
+
+        public:
+            static constexpr size_t trackCapacity = 16384;
+            static constexpr size_t statsSampleCount = 300; // Rolling stats cover this many of the latest records per zone
+
+            static bool isEnabled() noexcept;
+            static void setEnabled(bool value) noexcept;
+            static int64_t now() noexcept;
+
+            static ProfileTrack &getThreadTrack(); // Created on the thread's first zone
+            static ProfileTrack &createTrack(std::string_view name, bool gpu);
+
+            static ProfileStats getStats(std::string_view zoneName, bool gpu = false);
+            static std::string formatStats(); // One line per zone, CPU then GPU
+            static void writeChromeTrace(const std::filesystem::path &path); // Open in chrome://tracing or ui.perfetto.dev
+            static void clear();
+    };
+
+
+    // CPU zone on the calling thread's track. Nestable, costs one atomic load while the profiler is disabled. A thread's first zone allocates its track.
+    class ProfileZone {
+        private:
+            const char *name;
+            ProfileTrack *track = nullptr;
+            int64_t start = 0;
+            uint32_t depth = 0;
+
+        public:
+            explicit ProfileZone(const char *name);
+            ProfileZone(const ProfileZone &) = delete;
+
+            ProfileZone &operator=(const ProfileZone &) = delete;
+
+            ~ProfileZone() noexcept;
+    };
+
+
+    // GPU timestamps for one context. Queries are read back 'latency' frames later so the CPU never waits on them.
+    // Timestamps instead of GL_TIME_ELAPSED: only one elapsed query can be active at a time, so those can't nest.
+    class GpuTimerPool {
+        private:
+            struct Zone {
+                const char *name = nullptr;
+                uint32_t beginQuery = 0, endQuery = 0;
+                uint32_t depth = 0;
+            };
+
+            std::array<std::vector<Zone>, 4> frames;
+            std::vector<uint32_t> freeQueries;
+            uint64_t frameIndex = 0;
+            ProfileTrack &track;
+            int64_t gpuToCpuOffset = 0;
+            size_t droppedFrameCount = 0;
+
+            uint32_t acquireQuery();
+            void calibrate();
+            void collect(std::vector<Zone> &zones);
+
+        public:
+            static constexpr size_t latency = std::tuple_size_v<decltype(frames)>;
+            static constexpr size_t noZone = std::numeric_limits<size_t>::max();
+
+            explicit GpuTimerPool(std::string_view trackName); // Needs its context current
+            GpuTimerPool(const GpuTimerPool &) = delete;
+
+            void beginFrame();
+            size_t begin(const char *name);
+            void end(size_t zone);
+            size_t getDroppedFrameCount() const noexcept; // Frames whose results still weren't available after 'latency' frames
+
+            GpuTimerPool &operator=(const GpuTimerPool &) = delete;
+
+            ~GpuTimerPool() noexcept; // Needs its context current too, 'Window' destroys it before the context
+    };
+
+
+    // GPU zone on the current context's pool
+    class GpuProfileZone {
+        private:
+            GpuTimerPool *pool = nullptr;
+            size_t zone = GpuTimerPool::noZone;
+
+        public:
+            explicit GpuProfileZone(const char *name);
+            GpuProfileZone(const GpuProfileZone &) = delete;
+
+            GpuProfileZone &operator=(const GpuProfileZone &) = delete;
+
+            ~GpuProfileZone() noexcept;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+#include "renderQueue.hpp"
+#include "profiler.hpp"
+
+namespace CG {
+    void RenderQueue::radixSort(std::vector<Entry> &entries, std::vector<Entry> &scratch) {
+        // LSD, one byte per pass. Stable, so equal keys keep their submission order.
+        scratch.resize(entries.size());
+
+        std::array<std::array<uint32_t, 256>, sizeof(uint64_t)> histograms = {};
+        for (const Entry &entry: entries) {
+            for (size_t pass = 0; pass < sizeof(uint64_t); ++pass) ++histograms[pass][(entry.key >> (pass * 8)) & 0xFF];
+        }
+
+        for (size_t pass = 0; pass < sizeof(uint64_t); ++pass) {
+            std::array<uint32_t, 256> &histogram = histograms[pass];
+
+            // Every key has the same byte here, ex.: unused layers, the pass would only copy
+            if (std::find(histogram.begin(), histogram.end(), entries.size()) != histogram.end()) continue;
+
+            uint32_t offset = 0;
+            for (uint32_t &count: histogram) {
+                const uint32_t bucketCount = count;
+                count = offset;
+                offset += bucketCount;
+            }
+
+            for (const Entry &entry: entries) scratch[histogram[(entry.key >> (pass * 8)) & 0xFF]++] = entry;
+            entries.swap(scratch);
+        }
+    }
+
+    uint64_t RenderQueue::makeSortKey(uint8_t layer, bool translucent, uint16_t shaderId, uint16_t materialId, float32_t depth) noexcept {
+        const uint64_t quantizedDepth = static_cast<uint64_t>(std::clamp(depth, 0.0f, 1.0f) * maxDepth);
+
+        uint64_t result = ((static_cast<uint64_t>(layer) << 56) | (static_cast<uint64_t>(translucent) << 55));
+        if (translucent) result |= (((maxDepth - quantizedDepth) << 32) | (static_cast<uint64_t>(shaderId) << 16) | materialId);
+        else result |= ((static_cast<uint64_t>(shaderId) << 39) | (static_cast<uint64_t>(materialId) << depthBits) | quantizedDepth);
+        return result;
+    }
+
+    void RenderQueue::submit(const RenderItem &item) {
+        ASSERT((item.shader != nullptr) && (item.mesh != nullptr));
+
+        // GL names are small and fixed at creation, no per frame lookup. Past 65535 they repeat, which only costs sorting precision.
+        const uint16_t shaderId = static_cast<uint16_t>(item.shader->getId());
+        const uint16_t materialId = ((item.texture != nullptr) ? static_cast<uint16_t>(item.texture->getId()) : 0); // Names start at 1
+        entries.push_back({makeSortKey(item.layer, item.translucent, shaderId, materialId, item.depth), static_cast<uint32_t>(items.size())});
+        items.push_back(item);
+    }
+
+    size_t RenderQueue::getCount() const noexcept {return items.size();}
+
+    void RenderQueue::execute() {
+        CG_PROFILE_ZONE("RenderQueue::execute");
+
+        stats = {};
+        radixSort(entries, scratch);
+
+        Shader *shader = nullptr;
+        const Texture *texture = nullptr;
+        const Mesh *mesh = nullptr;
+        for (const Entry &entry: entries) {
+            const RenderItem &item = items[entry.item];
+
+            const bool programChanged = (item.shader != shader);
+            if (programChanged) {
+                shader = item.shader;
+                ++stats.programChanges;
+            }
+
+            // The sampler uniform is per program, so it's set again after a program change, the shadow store elides it if it's the same
+            if ((item.texture != nullptr) && ((item.texture != texture) || programChanged)) {
+                if (item.texture != texture) ++stats.textureChanges;
+                texture = item.texture;
+                shader->setUniform<int32_t>(item.textureUniform, texture->bind());
+            }
+
+            shader->setUniform<Matrix4>(item.transformUniform, item.transform);
+            if (programChanged) shader->bind();
+            else shader->flushUniforms();
+
+            if (item.mesh != mesh) {
+                mesh = item.mesh;
+                mesh->bind();
+                ++stats.meshChanges;
+            }
+
+            glDrawElements(GL_TRIANGLES, mesh->getIndexCount(), mesh->getIndexType(), nullptr);
+            ++stats.drawCount;
+        }
+
+        clear();
+    }
+
+    void RenderQueue::clear() noexcept {
+        items.clear();
+        entries.clear();
+    }
+
+    const RenderQueueStats &RenderQueue::getStats() const noexcept {return stats;}
+}
\ No newline at end of file
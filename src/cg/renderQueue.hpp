@@ -0,0 +1,60 @@
+#pragma once
+
+#include "_cgControl.hpp"
+#include "shader.hpp"
+#include "texture.hpp"
+#include "mesh.hpp"
+
+namespace CG {
+    // One draw submitted to a 'RenderQueue'. Pointed to objects must live until the queue executes.
+    struct RenderItem {
+        Shader *shader = nullptr;
+        const Mesh *mesh = nullptr;
+        const Texture *texture = nullptr; // Optional, bound and set to 'textureUniform'
+        UniformHandle textureUniform;
+        UniformHandle transformUniform; // Optional, set to 'transform'
+        Matrix4 transform = Matrix4::identity;
+        uint8_t layer = 0; // Lower layers draw first, ex.: world, then effects, then UI
+        bool translucent = false; // Drawn back to front after the opaque items of its layer
+        float32_t depth = 0.0f; // View distance over the far plane, in [0, 1]
+    };
+
+
+    // State changes the last execution made, one of each is the minimum for a frame that uses it at all
+    struct RenderQueueStats {
+        size_t drawCount = 0;
+        size_t programChanges = 0;
+        size_t textureChanges = 0;
+        size_t meshChanges = 0; // Vertex and index buffer switches, every window has a single vertex array
+    };
+
+
+    // Collects a frame's draws, then sorts them by a 64 bit key so consecutive draws share as much state as possible.
+    // Opaque keys, most significant first: layer 8 | translucent 0 | shader 16 | material 16 | depth 23, front to back within the same state.
+    // Translucent keys:                   layer 8 | translucent 1 | inverted depth 23 | shader 16 | material 16, back to front first, for correct blending.
+    class RenderQueue {
+        private:
+            struct Entry {
+                uint64_t key = 0;
+                uint32_t item = 0;
+            };
+
+            std::vector<RenderItem> items;
+            std::vector<Entry> entries, scratch;
+            RenderQueueStats stats;
+
+            static void radixSort(std::vector<Entry> &entries, std::vector<Entry> &scratch);
+
+        public:
+            static constexpr uint32_t depthBits = 23;
+            static constexpr uint32_t maxDepth = ((1u << depthBits) - 1);
+
+            static uint64_t makeSortKey(uint8_t layer, bool translucent, uint16_t shaderId, uint16_t materialId, float32_t depth) noexcept;
+
+            void submit(const RenderItem &item);
+            size_t getCount() const noexcept; // Submitted since the last execution
+            void execute(); // Sorts, draws and clears. Counts into 'getStats'.
+            void clear() noexcept;
+            const RenderQueueStats &getStats() const noexcept; // Of the last execution
+    };
+}
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include "resourceQueue.hpp"
+#include "window.hpp"
+
+namespace CG {
+    bool ResourceTicket::isReady() const {
+        const std::lock_guard lock(mutex);
+        return done;
+    }
+
+    void ResourceTicket::wait() const {
+        std::unique_lock lock(mutex);
+        executed.wait(lock, [this]() {return done;});
+
+        if (error) std::rethrow_exception(error);
+
+        // Server side wait, the CPU doesn't block on the GPU
+        if ((fence != nullptr) && (glfwGetCurrentContext() != nullptr)) glWaitSync(fence, 0, GL_TIMEOUT_IGNORED);
+    }
+
+
+    bool ResourceQueue::isReferenced(const Fence &fence) noexcept {
+        return std::any_of(fence.tickets.begin(), fence.tickets.end(), [](const auto &ticket) {return !ticket.expired();});
+    }
+
+    void ResourceQueue::deleteUnreferencedFences() {
+        std::erase_if(fences, [](const Fence &fence) {
+            if (isReferenced(fence)) return false;
+
+            glDeleteSync(fence.sync);
+            return true;
+        });
+    }
+
+    ResourceQueue::ResourceQueue() {
+        if (Window::getInstances().empty()) {
+            throw std::runtime_error("Resource queue needs a window to share objects with:\n" + std::to_string(std::stacktrace::current()));
+        }
+
+        GLFWwindow *const previousContext = glfwGetCurrentContext();
+
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        context = glfwCreateWindow(1, 1, "", nullptr, Window::getInstances()[0]->getWPtr());
+        glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+
+        if (context == nullptr) {
+            throw std::runtime_error("Failed to create the resource queue's context:\n" + std::to_string(std::stacktrace::current()));
+        }
+
+        glfwMakeContextCurrent(context);
+        glGenVertexArrays(1, &vaoId);
+        glBindVertexArray(vaoId);
+        glfwMakeContextCurrent(previousContext);
+    }
+
+    std::shared_ptr<ResourceTicket> ResourceQueue::submit(std::function<void()> work) {
+        auto ticket = std::make_shared<ResourceTicket>();
+
+        const std::lock_guard lock(mutex);
+        commands.push_back({std::move(work), ticket});
+        return ticket;
+    }
+
+    void ResourceQueue::execute() {
+        std::vector<Command> batch;
+        {
+            const std::lock_guard lock(mutex);
+            batch.swap(commands);
+        }
+
+        // Nothing that needs the context, skip switching to it
+        if (batch.empty() && std::all_of(fences.begin(), fences.end(), isReferenced)) return;
+
+        GLFWwindow *const previousContext = glfwGetCurrentContext();
+        glfwMakeContextCurrent(context);
+
+        deleteUnreferencedFences();
+
+        if (!batch.empty()) {
+            std::vector<std::exception_ptr> errors(batch.size(), nullptr);
+            for (size_t i = 0; i < batch.size(); ++i) {
+                try {
+                    batch[i].work();
+                }
+                catch (...) {
+                    errors[i] = std::current_exception();
+                }
+            }
+
+            // Flushed, or other contexts could wait on a fence that never reaches the GPU
+            Fence fence;
+            fence.sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            glFlush();
+
+            for (size_t i = 0; i < batch.size(); ++i) {
+                ResourceTicket &ticket = *batch[i].ticket;
+                {
+                    const std::lock_guard lock(ticket.mutex);
+                    ticket.fence = fence.sync;
+                    ticket.error = errors[i];
+                    ticket.done = true;
+                }
+                ticket.executed.notify_all();
+
+                fence.tickets.push_back(batch[i].ticket);
+            }
+            fences.push_back(std::move(fence));
+        }
+
+        batch.clear(); // Captures may own GL objects, released while the queue's context is still current
+        glfwMakeContextCurrent(previousContext);
+    }
+
+    ResourceQueue::~ResourceQueue() noexcept {
+        execute(); // Pending destructions
+
+        GLFWwindow *const previousContext = glfwGetCurrentContext();
+        glfwMakeContextCurrent(context);
+        for (const auto &fence: fences) glDeleteSync(fence.sync);
+        glDeleteVertexArrays(1, &vaoId);
+        glfwMakeContextCurrent((previousContext == context)? nullptr:previousContext);
+
+        glfwDestroyWindow(context);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <mutex>
+#include <condition_variable>
+#include "_cgControl.hpp"
+
+namespace CG {
+    // Completion of one queued command. The fence covers the GL work, so the result is usable from any context in the share group once 'wait' returns.
+    class ResourceTicket {
+        friend class ResourceQueue;
+
+        private:
+            mutable std::mutex mutex;
+            mutable std::condition_variable executed;
+            bool done = false;
+            GLsync fence = nullptr; // Owned by the queue, deleted once no ticket refers to it
+            std::exception_ptr error = nullptr;
+
+        public:
+            bool isReady() const;
+            void wait() const; // Blocks until executed, then makes the current context's command stream wait on the fence. Rethrows what the command threw.
+    };
+
+
+    template<typename T>
+    class PendingResource {
+        friend class ResourceQueue;
+
+        private:
+            std::shared_ptr<ResourceTicket> ticket;
+            std::shared_ptr<std::optional<T>> value;
+
+            PendingResource(std::shared_ptr<ResourceTicket> ticket, std::shared_ptr<std::optional<T>> value);
+
+        public:
+            bool isReady() const;
+            T take(); // Waits like 'ResourceTicket::wait', then moves the resource out. Call once, and not on the queue's own thread before it executed.
+    };
+
+
+    // Creates and destroys shared GL objects on a hidden context that shares with every window, from any thread.
+    // Commands run when the owning thread calls 'execute', then one fence is inserted and flushed for the whole batch.
+    class ResourceQueue {
+        private:
+            struct Command {
+                std::function<void()> work;
+                std::shared_ptr<ResourceTicket> ticket;
+            };
+
+            struct Fence {
+                GLsync sync = nullptr;
+                std::vector<std::weak_ptr<ResourceTicket>> tickets;
+            };
+
+            GLFWwindow *context = nullptr;
+            uint32_t vaoId = 0; // Vertex attribute setup needs a bound vertex array in the core profile
+            std::mutex mutex;
+            std::vector<Command> commands;
+            std::vector<Fence> fences; // Only touched by the owning thread
+
+            static bool isReferenced(const Fence &fence) noexcept;
+
+            void deleteUnreferencedFences();
+
+        public:
+            ResourceQueue(); // On the main thread, after the first window exists
+            ResourceQueue(const ResourceQueue &) = delete;
+
+            std::shared_ptr<ResourceTicket> submit(std::function<void()> work); // Any thread
+
+            // 'factory' runs on the queue's context and returns the resource, ex.: 'queue.create([&]() {return Texture(path);})'
+            template<typename Factory> PendingResource<std::invoke_result_t<Factory>> create(Factory &&factory);
+
+            // The resource is released on the queue's context, so no render thread has to delete it mid frame
+            template<typename T> std::shared_ptr<ResourceTicket> destroy(T &&resource) requires (!std::is_lvalue_reference_v<T>);
+
+            void execute(); // On the owning thread. Leaves the previously current context current again.
+
+            ResourceQueue &operator=(const ResourceQueue &) = delete;
+
+            ~ResourceQueue() noexcept;
+    };
+
+
+    template<typename T>
+    PendingResource<T>::PendingResource(std::shared_ptr<ResourceTicket> ticket, std::shared_ptr<std::optional<T>> value):
+        ticket(std::move(ticket)), value(std::move(value)) {}
+
+    template<typename T>
+    bool PendingResource<T>::isReady() const {
+        return ticket->isReady();
+    }
+
+    template<typename T>
+    T PendingResource<T>::take() {
+        ticket->wait();
+        ASSERT(value->has_value());
+
+        T result = std::move(value->value());
+        value->reset();
+        return result;
+    }
+
+    template<typename Factory>
+    PendingResource<std::invoke_result_t<Factory>> ResourceQueue::create(Factory &&factory) {
+        using T = std::invoke_result_t<Factory>;
+
+        auto value = std::make_shared<std::optional<T>>();
+        auto ticket = submit([value, factory = std::forward<Factory>(factory)]() mutable {
+            value->emplace(factory());
+        });
+
+        return PendingResource<T>(std::move(ticket), std::move(value));
+    }
+
+    template<typename T>
+    std::shared_ptr<ResourceTicket> ResourceQueue::destroy(T &&resource) requires (!std::is_lvalue_reference_v<T>) {
+        auto holder = std::make_shared<std::optional<T>>(std::move(resource));
+        return submit([holder]() {
+            holder->reset();
+        });
+    }
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#include "sampler.hpp"
+
+namespace CG {
+    size_t SamplerStateHash::operator()(const SamplerState &state) const noexcept {
+        size_t result = std::hash<float32_t>{}(state.anisotropy);
+        for (const GLenum value: {static_cast<GLenum>(state.wrapModeU), static_cast<GLenum>(state.wrapModeV), static_cast<GLenum>(state.minificationMode), static_cast<GLenum>(state.magnificationMode)}) {
+            result = ((result * 31) ^ std::hash<GLenum>{}(value));
+        }
+        return result;
+    }
+
+
+    std::unordered_map<SamplerState, Sampler, SamplerStateHash> Sampler::cache = {};
+    std::mutex Sampler::cacheMutex;
+
+    Sampler::Sampler(const SamplerState &state): state(state) {
+        glCreateSamplers(1, &id);
+        glSamplerParameteri(id, GL_TEXTURE_WRAP_S, static_cast<GLenum>(state.wrapModeU));
+        glSamplerParameteri(id, GL_TEXTURE_WRAP_T, static_cast<GLenum>(state.wrapModeV));
+        glSamplerParameteri(id, GL_TEXTURE_MIN_FILTER, static_cast<GLenum>(state.minificationMode));
+        glSamplerParameteri(id, GL_TEXTURE_MAG_FILTER, static_cast<GLenum>(state.magnificationMode));
+        glSamplerParameterf(id, GL_TEXTURE_MAX_ANISOTROPY, state.anisotropy);
+    }
+
+    const Sampler &Sampler::get(const SamplerState &state) {
+        const std::lock_guard lock(cacheMutex); // Render threads resolve samplers concurrently, map nodes stay put so the reference outlives the lock
+
+        const auto iter = cache.find(state);
+        if (iter != cache.end()) return iter->second;
+        return cache.emplace(state, Sampler(state)).first->second;
+    }
+
+    size_t Sampler::getCacheSize() {
+        const std::lock_guard lock(cacheMutex);
+        return cache.size();
+    }
+
+    Sampler::Sampler(Sampler &&other) noexcept: id(other.id), state(other.state) {
+        other.id = 0;
+    }
+
+    uint32_t Sampler::getId() const noexcept {return id;}
+
+    const SamplerState &Sampler::getState() const noexcept {return state;}
+
+    Sampler &Sampler::operator=(Sampler &&other) noexcept {
+        if (this == &other) return (*this);
+
+        if (id != 0) glDeleteSamplers(1, &id);
+        id = other.id;
+        state = other.state;
+        other.id = 0;
+        return (*this);
+    }
+
+    Sampler::~Sampler() noexcept {
+        if ((id != 0) && (glfwGetCurrentContext() != nullptr)) glDeleteSamplers(1, &id); // The static cache outlives every context
+    }
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <mutex>
+#include "_cgControl.hpp"
+
+namespace CG {
+    enum class TextureWrapMode {
+        Default        = GL_REPEAT         ,
+        Repeat         = GL_REPEAT         ,
+        MirroredRepeat = GL_MIRRORED_REPEAT,
+        ClampToEdge    = GL_CLAMP_TO_EDGE  ,
+        ClampToBorder  = GL_CLAMP_TO_BORDER,
+    };
+
+    enum class TextureMinificationMode {
+        Default              = GL_LINEAR_MIPMAP_LINEAR  ,
+        Nearest              = GL_NEAREST               ,
+        Linear               = GL_LINEAR                ,
+        NearestMipmapNearest = GL_NEAREST_MIPMAP_NEAREST,
+        LinearMipmapNearest  = GL_LINEAR_MIPMAP_NEAREST ,
+        NearestMipmapLinear  = GL_NEAREST_MIPMAP_LINEAR ,
+        LinearMipmapLinear   = GL_LINEAR_MIPMAP_LINEAR
+    };
+
+    enum class TextureMagnificationMode {
+        Default = GL_LINEAR ,
+        Nearest = GL_NEAREST,
+        Linear  = GL_LINEAR ,
+    };
+
+
+    struct SamplerState {
+        TextureWrapMode wrapModeU = TextureWrapMode::Default, wrapModeV = TextureWrapMode::Default;
+        TextureMinificationMode minificationMode = TextureMinificationMode::Default;
+        TextureMagnificationMode magnificationMode = TextureMagnificationMode::Default;
+        float32_t anisotropy = 1.0f;
+
+        bool operator==(const SamplerState &other) const = default;
+    };
+
+    struct SamplerStateHash {
+        size_t operator()(const SamplerState &state) const noexcept;
+    };
+
+
+    // Sampler objects are shared between contexts, so one cache serves every window. Each distinct state gets exactly one GL sampler.
+    // Cached samplers live as long as the program, so their references and ids can be kept instead of looked up again.
+    class Sampler {
+        private:
+            static std::unordered_map<SamplerState, Sampler, SamplerStateHash> cache;
+            static std::mutex cacheMutex;
+
+            uint32_t id = 0;
+            SamplerState state;
+
+            explicit Sampler(const SamplerState &state);
+
+        public:
+            static const Sampler &get(const SamplerState &state);
+            static size_t getCacheSize();
+
+            Sampler() = delete;
+            Sampler(const Sampler &) = delete;
+            Sampler(Sampler &&other) noexcept;
+
+            uint32_t getId() const noexcept;
+            const SamplerState &getState() const noexcept;
+
+            Sampler &operator=(const Sampler &) = delete;
+            Sampler &operator=(Sampler &&other) noexcept;
+
+            ~Sampler() noexcept;
+    };
+}
\ No newline at end of file
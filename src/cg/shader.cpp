@@ -1,6 +1,22 @@
+#include <cstring>
+#include <spanstream>
 #include "shader.hpp"
+#include "profiler.hpp"
+#include "resourceQueue.hpp"
+#include "assetFile.hpp"
 
 namespace CG {
+    void memoryBarrier(GpuBarrier barriers) noexcept {
+        glMemoryBarrier(static_cast<GLbitfield>(barriers));
+    }
+
+
+    struct Shader::VariantCache {
+        std::mutex mutex;
+        std::unordered_map<uint64_t, std::unique_ptr<Shader>> variants;
+        std::vector<std::pair<uint64_t, PendingResource<Shader>>> warmUps; // Not taken yet
+    };
+
     std::optional<ShaderStage> Shader::getShaderStageFromExtension(const std::filesystem::path &path) {
         const auto extension = path.extension();
 
@@ -17,7 +33,17 @@ namespace CG {
     void Shader::clearFields() noexcept {
         path.clear();
         id = 0;
-        uniformLocations.clear();
+        uniforms.clear();
+        uniformLookup.clear();
+        dirtyUniforms.clear();
+        elidedUniformCount = 0;
+        uploadedUniformCount = 0;
+        keywords.clear();
+        warmUpMasks.clear();
+        keywordMask = 0;
+        variantCache.reset();
+        dependencies.clear();
+        sourceHash = 0;
     }
 
     void Shader::moveFrom(Shader &other) {
@@ -25,7 +51,17 @@ namespace CG {
 
         path = std::move(other.path);
         id = other.id;
-        uniformLocations = std::move(other.uniformLocations);
+        uniforms = std::move(other.uniforms);
+        uniformLookup = std::move(other.uniformLookup);
+        dirtyUniforms = std::move(other.dirtyUniforms);
+        elidedUniformCount = other.elidedUniformCount;
+        uploadedUniformCount = other.uploadedUniformCount;
+        keywords = std::move(other.keywords);
+        warmUpMasks = std::move(other.warmUpMasks);
+        keywordMask = other.keywordMask;
+        variantCache = std::move(other.variantCache);
+        dependencies = std::move(other.dependencies);
+        sourceHash = other.sourceHash;
 
         other.clearFields();
     }
@@ -38,7 +74,7 @@ namespace CG {
     void Shader::initializeUniformLocations() {
         int32_t uniformCount;
         glGetProgramiv(this->id, GL_ACTIVE_UNIFORMS, &uniformCount);
-        this->uniformLocations.reserve(static_cast<size_t>(uniformCount));
+        this->uniforms.reserve(static_cast<size_t>(uniformCount));
 
         for (size_t i = 0; i < static_cast<size_t>(uniformCount); ++i) {
             int32_t maxUniformSizeWithNullTerminator; // The character count of the largest uniform name, counting the null terminator
@@ -58,31 +94,193 @@ namespace CG {
             }
             while (name[name.size() - 1] == '\0') name.pop_back(); // Eliminate null terminator characters at the end
 
-            this->uniformLocations[name] = glGetUniformLocation(this->id, name.c_str());
+            Uniform uniform;
+            uniform.hash = hashFnv1a(name);
+            uniform.location = glGetUniformLocation(this->id, name.c_str());
+            uniform.name = std::move(name);
+            this->uniformLookup.push_back({uniform.hash, static_cast<uint32_t>(this->uniforms.size())});
+            this->uniforms.push_back(std::move(uniform));
         }
+
+        sortUniformLookup();
     }
 
-    int32_t Shader::getUniformLocation(std::string_view name) const {
-        return uniformLocations.find(name)->second;
+    void Shader::sortUniformLookup() {
+        std::sort(uniformLookup.begin(), uniformLookup.end(), [](const auto &a, const auto &b) {return (a.first < b.first);});
     }
 
-    Shader::Shader(const Shader &other): Shader(other.path) {}
+    void Shader::adopt(Shader &&compiled) {
+        ASSERT(compiled.exists());
+
+        for (auto &uniform: uniforms) uniform.location = -1; // Slots of uniforms the new program dropped stay, inactive
+
+        for (auto &compiledUniform: compiled.uniforms) {
+            const UniformHandle handle = findUniform(UniformName(std::string_view(compiledUniform.name)));
+            if (!handle.isValid()) {
+                uniformLookup.push_back({compiledUniform.hash, static_cast<uint32_t>(uniforms.size())});
+                uniforms.push_back(std::move(compiledUniform));
+                continue;
+            }
+
+            // The program starts out with default values, so everything set before goes out again on the next flush
+            Uniform &uniform = uniforms[handle.index];
+            uniform.location = compiledUniform.location;
+            if ((uniform.upload != nullptr) && !uniform.dirty) {
+                uniform.dirty = true;
+                dirtyUniforms.push_back(handle.index);
+            }
+        }
+        sortUniformLookup();
+
+        if (exists()) glDeleteProgram(id);
+        id = std::exchange(compiled.id, 0);
+        keywords = std::move(compiled.keywords);
+        warmUpMasks = std::move(compiled.warmUpMasks);
+        dependencies = std::move(compiled.dependencies);
+        sourceHash = compiled.sourceHash;
+
+        compiled.clearFields();
+    }
+
+    std::vector<Shader *> Shader::getVariants() const {
+        const std::lock_guard lock(variantCache->mutex);
+
+        std::vector<Shader *> result;
+        for (const auto &[mask, variant]: variantCache->variants) {
+            if (variant != nullptr) result.push_back(variant.get());
+        }
+        return result;
+    }
+
+    int32_t Shader::getUniformLocation(UniformHandle handle) const {
+        if (!handle.isValid()) return -1; // Ignored by glUniform*
+        ASSERT(handle.index < uniforms.size());
+        return uniforms[handle.index].location;
+    }
+
+    void Shader::stageUniform(UniformHandle handle, const void *values, size_t size, int32_t count, UniformUploadFunction upload) {
+        if (!handle.isValid()) return;
+        ASSERT(handle.index < uniforms.size());
+
+        Uniform &uniform = uniforms[handle.index];
+        if ((uniform.upload == upload) && (uniform.value.size() == size) && (std::memcmp(uniform.value.data(), values, size) == 0)) {
+            ++elidedUniformCount;
+            return;
+        }
+
+        const std::byte *const bytes = static_cast<const std::byte *>(values);
+        uniform.value.assign(bytes, (bytes + size));
+        uniform.count = count;
+        uniform.upload = upload;
 
-    Shader::Shader(const std::filesystem::path &path) {
+        if (!uniform.dirty) {
+            uniform.dirty = true;
+            dirtyUniforms.push_back(handle.index);
+        }
+    }
+
+    UniformHandle Shader::findUniform(UniformName name) const noexcept {
+        auto iter = std::lower_bound(uniformLookup.begin(), uniformLookup.end(), name.getHash(), [](const auto &entry, uint64_t hash) {return (entry.first < hash);});
+        for (; (iter != uniformLookup.end()) && (iter->first == name.getHash()); ++iter) {
+            if (uniforms[iter->second].name == name.getName()) return {iter->second};
+        }
+
+        return {};
+    }
+
+    UniformHandle Shader::getUniformHandle(UniformName name) const {
+        const UniformHandle result = findUniform(name);
+        if (result.isValid()) return result;
+
+        #if _DEBUG
+            std::clog << "Shader \"" << path.string() << "\" has no active uniform named \"" << name.getName() << "\"\n";
+        #endif
+
+        return {};
+    }
+
+    uint64_t Shader::getKeywordBit(std::string_view keyword) const {
+        const auto iter = std::find(keywords.begin(), keywords.end(), keyword);
+        if (iter == keywords.end()) {
+            throw std::runtime_error("Shader \"" + path.string() + "\" has no keyword \"" + std::string(keyword) + "\":\n" + std::to_string(std::stacktrace::current()));
+        }
+
+        return (uint64_t(1) << (iter - keywords.begin()));
+    }
+
+    void Shader::collectWarmUps() {
+        auto &warmUps = variantCache->warmUps;
+        for (size_t i = 0; i < warmUps.size();) {
+            if (!warmUps[i].second.isReady()) {
+                ++i;
+                continue;
+            }
+
+            auto [mask, pending] = std::move(warmUps[i]);
+            warmUps.erase(warmUps.begin() + i);
+
+            // Compiled here in the meantime if it was needed before the queue got to it, the duplicate goes
+            Shader variant = pending.take();
+            auto &cached = variantCache->variants[mask];
+            if (cached == nullptr) cached = std::make_unique<Shader>(std::move(variant));
+        }
+    }
+
+    Shader::Shader(const Shader &other): Shader(other.path, other.keywordMask) {}
+
+    Shader::Shader(const std::filesystem::path &path): Shader(path, 0) {}
+
+    Shader::Shader(const std::filesystem::path &path, uint64_t keywordMask): path(path), keywordMask(keywordMask), variantCache(std::make_unique<VariantCache>()) {
         using namespace std::string_literals;
 
-        const YAML::Node file = YAML::LoadFile(path.string());
-        ASSERT((!(file["vertex"].IsNull())) && (!(file["fragment"].IsNull())));
+        const AssetFile asset(path);
+        std::ispanstream stream(std::span<const char>(asset.getText().data(), asset.getSize()));
+        const YAML::Node file = YAML::Load(stream);
+
+        // A graphics program needs at least a vertex and a fragment stage, a compute program has the compute stage alone
+        const bool graphics = std::ranges::any_of(std::array{"vertex", "tessControl", "tessEvaluation", "geometry", "fragment"}, [&](const char *stage) {return file[stage].IsDefined();});
+        if (file["compute"].IsDefined()) {
+            if (graphics) throw std::runtime_error("Shader \"" + path.string() + "\" mixes a compute stage with graphics stages:\n" + std::to_string(std::stacktrace::current()));
+        }
+        else if (!(file["vertex"].IsDefined() && file["fragment"].IsDefined())) {
+            throw std::runtime_error("Shader \"" + path.string() + "\" needs a vertex and a fragment stage, or a compute stage:\n" + std::to_string(std::stacktrace::current()));
+        }
+
+        for (const auto &keyword: file["keywords"]) keywords.push_back(keyword.as<std::string>());
+        if (keywords.size() > 64) throw std::runtime_error("Shader \"" + path.string() + "\" declares more than 64 keywords:\n" + std::to_string(std::stacktrace::current()));
+
+        for (const auto &keywordSet: file["warmUp"]) {
+            uint64_t mask = 0;
+            for (const auto &keyword: keywordSet) mask |= getKeywordBit(keyword.as<std::string>());
+            warmUpMasks.push_back(mask);
+        }
+
+        std::string defines = "";
+        for (size_t i = 0; i < keywords.size(); ++i) {
+            if (keywordMask & (uint64_t(1) << i)) defines += "#define " + keywords[i] + '\n';
+        }
 
         const std::array<CompiledShaderStage, 6> stages = {
-            CompiledShaderStage(file["vertex"        ].as<std::string>(""s)),
-            CompiledShaderStage(file["tessControl"   ].as<std::string>(""s)),
-            CompiledShaderStage(file["tessEvaluation"].as<std::string>(""s)),
-            CompiledShaderStage(file["geometry"      ].as<std::string>(""s)),
-            CompiledShaderStage(file["fragment"      ].as<std::string>(""s)),
-            CompiledShaderStage(file["compute"       ].as<std::string>(""s))
+            CompiledShaderStage(file["vertex"        ].as<std::string>(""s), defines),
+            CompiledShaderStage(file["tessControl"   ].as<std::string>(""s), defines),
+            CompiledShaderStage(file["tessEvaluation"].as<std::string>(""s), defines),
+            CompiledShaderStage(file["geometry"      ].as<std::string>(""s), defines),
+            CompiledShaderStage(file["fragment"      ].as<std::string>(""s), defines),
+            CompiledShaderStage(file["compute"       ].as<std::string>(""s), defines)
         };
 
+        this->dependencies.push_back({ShaderSources::normalize(path), AssetFile::getModifiedTime(path).value_or(std::filesystem::file_time_type())});
+
+        std::vector<uint64_t> stageHashes;
+        for (const auto &stage: stages) {
+            for (const auto &source: stage.sources) {
+                const bool known = std::any_of(this->dependencies.begin(), this->dependencies.end(), [&](const ShaderSourceFile &file) {return (file.path == source.path);});
+                if (!known) this->dependencies.push_back(source);
+            }
+            stageHashes.push_back(stage.sourceHash);
+        }
+        this->sourceHash = hashFnv1a(std::string_view(reinterpret_cast<const char *>(stageHashes.data()), (stageHashes.size() * sizeof(uint64_t))));
+
         this->id = glCreateProgram();
 
         for (const auto &stage: stages) {
@@ -90,6 +288,22 @@ namespace CG {
         }
 
         glLinkProgram(this->id);
+
+        int32_t linkSuccessful;
+        glGetProgramiv(this->id, GL_LINK_STATUS, &linkSuccessful);
+        if (!linkSuccessful) {
+            int32_t messageLength;
+            glGetProgramiv(this->id, GL_INFO_LOG_LENGTH, &messageLength);
+
+            std::string msg;
+            msg.resize(static_cast<size_t>(messageLength), ' ');
+            glGetProgramInfoLog(this->id, messageLength, &messageLength, msg.data());
+
+            glDeleteProgram(this->id);
+            this->id = 0;
+            throw std::runtime_error("Error linking shader \"" + path.string() + "\":" + msg + '\n' + std::to_string(std::stacktrace::current()));
+        }
+
         glValidateProgram(this->id);
 
         initializeUniformLocations();
@@ -100,7 +314,7 @@ namespace CG {
     }
 
     Shader &Shader::operator=(const Shader &other) {
-        (*this) = Shader(other.path);
+        (*this) = Shader(other.path, other.keywordMask);
         return (*this);
     }
 
@@ -110,8 +324,93 @@ namespace CG {
     }
 
     bool Shader::exists() const noexcept {return (id != 0);}
+    uint32_t Shader::getId() const noexcept {return id;}
+
+    Shader &Shader::getVariant(std::initializer_list<std::string_view> keywords) {
+        return getVariant(std::span<const std::string_view>(keywords.begin(), keywords.size()));
+    }
+
+    Shader &Shader::getVariant(std::span<const std::string_view> keywords) {
+        ASSERT(exists());
+
+        uint64_t mask = 0;
+        for (const std::string_view keyword: keywords) mask |= getKeywordBit(keyword);
+        if (mask == keywordMask) return (*this);
+
+        const std::lock_guard lock(variantCache->mutex);
+        collectWarmUps();
+
+        auto &variant = variantCache->variants[mask];
+        if (variant == nullptr) variant = std::unique_ptr<Shader>(new Shader(path, mask));
+        return (*variant);
+    }
+
+    void Shader::warmUp(ResourceQueue &queue) {
+        ASSERT(exists());
+
+        const std::lock_guard lock(variantCache->mutex);
+        for (const uint64_t mask: warmUpMasks) {
+            const bool pending = std::any_of(variantCache->warmUps.begin(), variantCache->warmUps.end(), [&](const auto &warmUp) {return (warmUp.first == mask);});
+            if ((mask == keywordMask) || pending || variantCache->variants.contains(mask)) continue;
+
+            variantCache->warmUps.emplace_back(mask, queue.create([path = path, mask]() {return Shader(path, mask);}));
+        }
+    }
+
+    size_t Shader::getPendingWarmUpCount() {
+        const std::lock_guard lock(variantCache->mutex);
+        collectWarmUps();
+        return variantCache->warmUps.size();
+    }
+
+    std::span<const std::string> Shader::getKeywords() const noexcept {return keywords;}
+
+    size_t Shader::getVariantCount() const {
+        const std::lock_guard lock(variantCache->mutex);
+        return variantCache->variants.size();
+    }
+
+    std::span<const ShaderSourceFile> Shader::getDependencies() const noexcept {return dependencies;}
+
+    bool Shader::dependsOn(const std::filesystem::path &file) const {
+        const std::filesystem::path normalized = ShaderSources::normalize(file);
+        return std::any_of(dependencies.begin(), dependencies.end(), [&](const ShaderSourceFile &dependency) {return (dependency.path == normalized);});
+    }
+
+    bool Shader::isOutOfDate() const {
+        return std::any_of(dependencies.begin(), dependencies.end(), [](const ShaderSourceFile &dependency) {
+            return (AssetFile::getModifiedTime(dependency.path) != dependency.modifiedTime);
+        });
+    }
+
+    uint64_t Shader::getSourceHash() const noexcept {return sourceHash;}
+
+    void Shader::bind() noexcept {
+        CG_PROFILE_ZONE("Shader::bind");
+        flushUniforms();
+        glUseProgram(id);
+    }
+
+    void Shader::dispatch(uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ) noexcept {
+        CG_PROFILE_ZONE("Shader::dispatch");
+        bind();
+        glDispatchCompute(groupsX, groupsY, groupsZ);
+    }
+
+    void Shader::flushUniforms() noexcept {
+        // Program uniforms are direct state access, the program doesn't need to be bound
+        for (const uint32_t index: dirtyUniforms) {
+            Uniform &uniform = uniforms[index];
+            uniform.upload(id, uniform.location, uniform.count, uniform.value.data());
+            uniform.dirty = false;
+        }
+
+        uploadedUniformCount += dirtyUniforms.size();
+        dirtyUniforms.clear();
+    }
 
-    void Shader::bind() const noexcept {glUseProgram(id);}
+    size_t Shader::getElidedUniformCount() const noexcept {return elidedUniformCount;}
+    size_t Shader::getUploadedUniformCount() const noexcept {return uploadedUniformCount;}
 
     Shader::~Shader() noexcept {destroy();}
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "_cgControl.hpp"
 #include "hash.hpp"
+#include "shaderSource.hpp"
 
 namespace CG {
     enum class ShaderStage {
@@ -14,15 +15,81 @@ namespace CG {
     };
 
 
+    // What has to see the writes of shaders issued before a 'memoryBarrier', by how it reads them afterwards
+    enum class GpuBarrier: uint32_t {
+        VertexAttribArray = GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT ,
+        ElementArray      = GL_ELEMENT_ARRAY_BARRIER_BIT       ,
+        Uniform           = GL_UNIFORM_BARRIER_BIT             ,
+        TextureFetch      = GL_TEXTURE_FETCH_BARRIER_BIT       ,
+        ImageAccess       = GL_SHADER_IMAGE_ACCESS_BARRIER_BIT ,
+        Command           = GL_COMMAND_BARRIER_BIT             , // Indirect draw and dispatch arguments
+        PixelBuffer       = GL_PIXEL_BUFFER_BARRIER_BIT        ,
+        TextureUpdate     = GL_TEXTURE_UPDATE_BARRIER_BIT      ,
+        BufferUpdate      = GL_BUFFER_UPDATE_BARRIER_BIT       ,
+        Framebuffer       = GL_FRAMEBUFFER_BARRIER_BIT         ,
+        TransformFeedback = GL_TRANSFORM_FEEDBACK_BARRIER_BIT  ,
+        AtomicCounter     = GL_ATOMIC_COUNTER_BARRIER_BIT      ,
+        ShaderStorage     = GL_SHADER_STORAGE_BARRIER_BIT      ,
+        MappedBuffer      = GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT,
+        QueryBuffer       = GL_QUERY_BUFFER_BARRIER_BIT        ,
+        All               = GL_ALL_BARRIER_BITS
+    };
+
+    constexpr GpuBarrier operator|(GpuBarrier a, GpuBarrier b) noexcept {
+        return static_cast<GpuBarrier>(static_cast<uint32_t>(a) | static_cast<uint32_t>(b));
+    }
+
+    void memoryBarrier(GpuBarrier barriers) noexcept;
+
+
+    // Uniform name with its hash, hashed at compile time when it's a literal
+    class UniformName {
+        private:
+            std::string_view name;
+            uint64_t hash;
+
+        public:
+            template<size_t N> consteval UniformName(const char (&name)[N]): name(name, (N - 1)), hash(hashFnv1a(this->name)) {}
+            constexpr UniformName(std::string_view name) noexcept: name(name), hash(hashFnv1a(name)) {}
+
+            constexpr std::string_view getName() const noexcept {return name;}
+            constexpr uint64_t getHash() const noexcept {return hash;}
+    };
+
+
+    // Resolved once with 'Shader::getUniformHandle', then indexes straight into that shader's locations. Only valid for the shader that returned it.
+    struct UniformHandle {
+        static constexpr uint32_t invalidIndex = std::numeric_limits<uint32_t>::max();
+
+        uint32_t index = invalidIndex;
+
+        constexpr bool isValid() const noexcept {return (index != invalidIndex);}
+    };
+
+
+    class ResourceQueue;
+
+
+    using UniformUploadFunction = void (*)(uint32_t program, int32_t location, int32_t count, const void *values);
+
+    // Specialized in uniform.cpp for every type a uniform can be set from
+    template<typename T> void uploadUniform(uint32_t program, int32_t location, int32_t count, const void *values);
+
+
     class Shader {
+        friend class HotReloader;
+        friend class CommandBuffer;
+
         private:
             // Move only RAII wrapper for compiled shader stage
             struct CompiledShaderStage {
                 uint32_t id = 0;
+                std::vector<ShaderSourceFile> sources; // The stage file and everything it includes
+                uint64_t sourceHash = 0;
 
                 CompiledShaderStage() = delete;
                 CompiledShaderStage(const CompiledShaderStage&) = delete;
-                CompiledShaderStage(const std::filesystem::path &path);
+                CompiledShaderStage(const std::filesystem::path &path, std::string_view defines = ""); // 'defines' goes right after the '#version' line
                 CompiledShaderStage(CompiledShaderStage &&other) noexcept;
 
                 CompiledShaderStage& operator=(CompiledShaderStage &&other) noexcept;
@@ -32,18 +99,50 @@ namespace CG {
                 ~CompiledShaderStage() noexcept;
             };
 
+            struct Uniform {
+                uint64_t hash = 0;
+                std::string name = "";
+                int32_t location = -1;
+
+                // Shadow of the last value set, uploaded on the next flush while dirty
+                std::vector<std::byte> value;
+                int32_t count = 0;
+                UniformUploadFunction upload = nullptr;
+                bool dirty = false;
+            };
+
+            struct VariantCache;
+
             static std::optional<ShaderStage> getShaderStageFromExtension(const std::filesystem::path &path);
             static CompiledShaderStage compileShaderStage(const std::filesystem::path &path);
 
             std::filesystem::path path = "";
             uint32_t id = 0;
-            std::unordered_map<std::string, int32_t, StringViewHash, StringViewEqual> uniformLocations;
+            std::vector<Uniform> uniforms; // A handle is an index into it. Slots are only ever added, so handles survive hot reloads.
+            std::vector<std::pair<uint64_t, uint32_t>> uniformLookup; // Hash and slot, sorted by hash
+            std::vector<uint32_t> dirtyUniforms;
+            size_t elidedUniformCount = 0, uploadedUniformCount = 0;
+            std::vector<std::string> keywords; // Bit i of a keyword mask defines keywords[i]
+            std::vector<uint64_t> warmUpMasks;
+            uint64_t keywordMask = 0;
+            std::unique_ptr<VariantCache> variantCache;
+            std::vector<ShaderSourceFile> dependencies; // The .shader file, then every stage source and include, as they were when compiled
+            uint64_t sourceHash = 0;
+
+            Shader(const std::filesystem::path &path, uint64_t keywordMask);
 
             void clearFields() noexcept;
             void moveFrom(Shader &other);
             void destroy();
             void initializeUniformLocations();
-            int32_t getUniformLocation(std::string_view name) const;
+            void sortUniformLookup();
+            UniformHandle findUniform(UniformName name) const noexcept;
+            void adopt(Shader &&compiled); // Takes the program of a recompiled copy, keeping handles, uniform values and variants
+            std::vector<Shader *> getVariants() const;
+            int32_t getUniformLocation(UniformHandle handle) const;
+            uint64_t getKeywordBit(std::string_view keyword) const;
+            void collectWarmUps();
+            void stageUniform(UniformHandle handle, const void *values, size_t size, int32_t count, UniformUploadFunction upload);
 
         public:
             Shader() = delete;
@@ -55,10 +154,49 @@ namespace CG {
             Shader &operator=(Shader &&other);
 
             bool exists() const noexcept;
-            void bind() const noexcept;
-
-            template<typename T> void setUniform(std::string_view name, const T &value) requires (!(std::is_pointer_v<T>) && !(std::is_array_v<T>));
-            template<typename T> void setUniform(std::string_view name, std::span<const T> values);
+            uint32_t getId() const noexcept; // GL program name, small and stable until deleted, ex.: to sort draws by
+
+            // Permutation with the given keywords defined, compiled on first use and cached. Unknown keywords throw.
+            Shader &getVariant(std::initializer_list<std::string_view> keywords);
+            Shader &getVariant(std::span<const std::string_view> keywords);
+            // Compiles the file's 'warmUp' keyword sets on the queue's context, 'getVariant' picks them up once done. Nothing compiles until the queue
+            // executes, which takes a thread of its own looping on 'execute', as 'HotReloader' has.
+            void warmUp(ResourceQueue &queue);
+            size_t getPendingWarmUpCount(); // Warm ups still compiling, after taking in the finished ones as 'getVariant' does
+            std::span<const std::string> getKeywords() const noexcept;
+            size_t getVariantCount() const;
+
+            std::span<const ShaderSourceFile> getDependencies() const noexcept;
+            bool dependsOn(const std::filesystem::path &file) const;
+            bool isOutOfDate() const; // A dependency changed on disk since compiling
+            uint64_t getSourceHash() const noexcept; // Of the final stage sources, defines included, ex.: to key cached program binaries
+
+            void bind() noexcept; // Flushes the dirty uniforms too, so bind right before drawing
+            void dispatch(uint32_t groupsX, uint32_t groupsY = 1, uint32_t groupsZ = 1) noexcept; // Binds, then runs the compute stage. Follow with a 'memoryBarrier' for whatever reads its writes.
+            void flushUniforms() noexcept;
+
+            size_t getElidedUniformCount() const noexcept; // Sets skipped because the value didn't change
+            size_t getUploadedUniformCount() const noexcept;
+
+            UniformHandle getUniformHandle(UniformName name) const; // Invalid handle for names that aren't active uniforms, setting through it does nothing
+
+            // Only staged, nothing reaches GL until the next flush and unchanged values never do
+            template<typename T> void setUniform(UniformHandle handle, const T &value) requires (!(std::is_pointer_v<T>) && !(std::is_array_v<T>)) {
+                stageUniform(handle, &value, sizeof(T), 1, &uploadUniform<T>);
+            }
+
+            template<typename T> void setUniform(UniformHandle handle, std::span<const T> values) {
+                stageUniform(handle, values.data(), values.size_bytes(), static_cast<int32_t>(values.size()), &uploadUniform<T>);
+            }
+
+            // Looks the name up on every call, prefer resolving a handle once for anything set per frame
+            template<typename T> void setUniform(UniformName name, const T &value) requires (!(std::is_pointer_v<T>) && !(std::is_array_v<T>)) {
+                setUniform<T>(getUniformHandle(name), value);
+            }
+
+            template<typename T> void setUniform(UniformName name, std::span<const T> values) {
+                setUniform<T>(getUniformHandle(name), values);
+            }
 
             ~Shader() noexcept;
     };
@@ -0,0 +1,107 @@
+#include "shaderSource.hpp"
+#include "assetFile.hpp"
+
+namespace CG {
+    std::unordered_map<std::string, ShaderSources::CachedFile> ShaderSources::cache = {};
+    std::mutex ShaderSources::cacheMutex;
+
+    std::optional<std::string_view> ShaderSources::parseInclude(std::string_view line) {
+        const size_t directive = line.find_first_not_of(" \t");
+        if ((directive == std::string_view::npos) || !line.substr(directive).starts_with("#include")) return std::nullopt;
+
+        const size_t start = line.find('"', directive);
+        const size_t end = (start == std::string_view::npos)? std::string_view::npos:line.find('"', (start + 1));
+        if (end == std::string_view::npos) return std::nullopt;
+
+        return line.substr((start + 1), (end - start - 1));
+    }
+
+    const ShaderSources::CachedFile &ShaderSources::load(const std::filesystem::path &path) {
+        const std::optional<std::filesystem::file_time_type> modifiedTime = AssetFile::getModifiedTime(path);
+        if (!modifiedTime.has_value()) throw std::runtime_error("Failed to open \"" + path.string() + "\":\n" + std::to_string(std::stacktrace::current()));
+
+        CachedFile &file = cache[path.string()];
+        if ((file.modifiedTime == modifiedTime.value()) && !file.text.empty()) return file;
+
+        // Copied out rather than kept mapped, a mapped file can't be saved over on every platform
+        file.text = AssetFile(path).getText();
+        file.includes.clear();
+        file.modifiedTime = modifiedTime.value();
+
+        std::string_view text = file.text;
+        while (!text.empty()) {
+            const size_t end = text.find('\n');
+            if (const auto include = parseInclude(text.substr(0, end))) file.includes.push_back(normalize(path.parent_path() / *include));
+            text.remove_prefix((end == std::string_view::npos)? text.size():(end + 1));
+        }
+
+        return file;
+    }
+
+    void ShaderSources::expand(const std::filesystem::path &path, ResolvedShaderSource &result) {
+        if (std::any_of(result.files.begin(), result.files.end(), [&](const ShaderSourceFile &file) {return (file.path == path);})) return;
+
+        const CachedFile &file = load(path);
+        const size_t sourceNumber = result.files.size();
+        result.files.push_back({path, file.modifiedTime});
+
+        if (sourceNumber != 0) result.text += "#line 1 " + std::to_string(sourceNumber) + '\n';
+
+        std::string_view text = file.text;
+        size_t includeIndex = 0;
+        for (size_t lineNumber = 1; !text.empty(); ++lineNumber) {
+            const size_t end = text.find('\n');
+            const std::string_view line = text.substr(0, end);
+            text.remove_prefix((end == std::string_view::npos)? text.size():(end + 1));
+
+            if (parseInclude(line).has_value()) {
+                expand(file.includes[includeIndex++], result);
+                result.text += "#line " + std::to_string(lineNumber + 1) + ' ' + std::to_string(sourceNumber) + '\n';
+                continue;
+            }
+
+            result.text += line;
+            result.text += '\n';
+        }
+    }
+
+    std::filesystem::path ShaderSources::normalize(const std::filesystem::path &path) {
+        std::error_code error;
+        const std::filesystem::path result = std::filesystem::weakly_canonical(path, error);
+        return (error? std::filesystem::absolute(path, error):result).lexically_normal();
+    }
+
+    ResolvedShaderSource ShaderSources::resolve(const std::filesystem::path &path) {
+        const std::lock_guard lock(cacheMutex);
+
+        ResolvedShaderSource result;
+        expand(normalize(path), result);
+        return result;
+    }
+
+    std::vector<std::filesystem::path> ShaderSources::getDependents(const std::filesystem::path &path) {
+        const std::lock_guard lock(cacheMutex);
+
+        std::vector<std::filesystem::path> result;
+        std::vector<std::filesystem::path> pending = {normalize(path)};
+        while (!pending.empty()) {
+            const std::filesystem::path included = std::move(pending.back());
+            pending.pop_back();
+
+            for (const auto &[name, file]: cache) {
+                const bool includes = (std::find(file.includes.begin(), file.includes.end(), included) != file.includes.end());
+                if (!includes || (std::find(result.begin(), result.end(), name) != result.end())) continue;
+
+                result.push_back(name);
+                pending.push_back(name);
+            }
+        }
+
+        return result;
+    }
+
+    void ShaderSources::clearCache() {
+        const std::lock_guard lock(cacheMutex);
+        cache.clear();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <mutex>
+#include "_cgControl.hpp"
+
+namespace CG {
+    struct ShaderSourceFile {
+        std::filesystem::path path = "";
+        std::filesystem::file_time_type modifiedTime = {};
+    };
+
+    struct ResolvedShaderSource {
+        std::string text = "";               // Includes expanded, '#line' directives map every line back to its file
+        std::vector<ShaderSourceFile> files; // Source string number 'i' of the '#line' directives is files[i], the stage file itself is 0
+    };
+
+
+    // Cache of shader source files, reread only when their modification time changes, and of which file includes which.
+    // '#include "file"' resolves relative to the including file. Every file is included at most once per stage, so cycles end on their own.
+    class ShaderSources {
+        private:
+            struct CachedFile {
+                std::string text = "";
+                std::filesystem::file_time_type modifiedTime = {};
+                std::vector<std::filesystem::path> includes; // Direct ones, normalized
+            };
+
+            static std::unordered_map<std::string, CachedFile> cache; // Keyed by normalized path
+            static std::mutex cacheMutex;
+
+            static std::optional<std::string_view> parseInclude(std::string_view line);
+            static const CachedFile &load(const std::filesystem::path &path); // Locked by the caller
+            static void expand(const std::filesystem::path &path, ResolvedShaderSource &result);
+
+        public:
+            static std::filesystem::path normalize(const std::filesystem::path &path); // Canonical, as far as the path exists
+            static ResolvedShaderSource resolve(const std::filesystem::path &path);
+            static std::vector<std::filesystem::path> getDependents(const std::filesystem::path &path); // Cached files that include it, directly or not
+            static void clearCache();
+    };
+}
\ No newline at end of file
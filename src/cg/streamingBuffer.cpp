@@ -0,0 +1,119 @@
+#include "streamingBuffer.hpp"
+
+namespace CG {
+    void StreamingBuffer::clearFields() noexcept {
+        id = 0;
+        mapped = nullptr;
+        regionSize = 0;
+        fences = {};
+        region = 0;
+        offset = 0;
+        stallCount = 0;
+    }
+
+    void StreamingBuffer::moveFrom(StreamingBuffer &other) noexcept {
+        if (this == &other) return;
+
+        id = other.id;
+        mapped = other.mapped;
+        regionSize = other.regionSize;
+        fences = other.fences;
+        region = other.region;
+        offset = other.offset;
+        stallCount = other.stallCount;
+
+        other.clearFields();
+    }
+
+    void StreamingBuffer::destroy() noexcept {
+        for (const GLsync fence: fences) {
+            if (fence != nullptr) glDeleteSync(fence);
+        }
+
+        // Deletion is deferred by GL until queued draws are done with it
+        if (exists()) {
+            glUnmapNamedBuffer(id);
+            glDeleteBuffers(1, &id);
+        }
+        clearFields();
+    }
+
+    void StreamingBuffer::allocateStorage(size_t regionSize) {
+        const size_t stallCount = this->stallCount;
+        destroy();
+
+        constexpr GLbitfield flags = (GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+        glCreateBuffers(1, &id);
+        glNamedBufferStorage(id, (regionSize * regionCount), nullptr, flags);
+        mapped = static_cast<std::byte *>(glMapNamedBufferRange(id, 0, (regionSize * regionCount), flags));
+
+        if (mapped == nullptr) {
+            destroy();
+            throw std::runtime_error("Failed to map a " + std::to_string(regionSize * regionCount) + " byte streaming buffer:\n" + std::to_string(std::stacktrace::current()));
+        }
+
+        this->regionSize = regionSize;
+        this->stallCount = stallCount;
+    }
+
+    StreamingBuffer::StreamingBuffer(size_t regionSize) {
+        ASSERT(regionSize > 0);
+        allocateStorage(regionSize);
+    }
+
+    StreamingBuffer::StreamingBuffer(StreamingBuffer &&other) noexcept {this->moveFrom(other);}
+
+    bool StreamingBuffer::exists() const noexcept {return (id != 0);}
+
+    StreamingBuffer::Allocation StreamingBuffer::allocate(size_t size, size_t alignment) {
+        ASSERT(exists() && (alignment > 0));
+
+        if (size > regionSize) allocateStorage(std::max(size, (regionSize * 2)));
+
+        size_t start = (((offset + alignment - 1) / alignment) * alignment);
+        if ((start + size) > regionSize) {
+            nextRegion();
+            start = 0;
+        }
+
+        offset = (start + size);
+        const size_t bufferOffset = ((region * regionSize) + start);
+        return {(mapped + bufferOffset), bufferOffset};
+    }
+
+    void StreamingBuffer::nextRegion() {
+        if (fences[region] != nullptr) glDeleteSync(fences[region]);
+        fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+        region = ((region + 1) % regionCount);
+        offset = 0;
+
+        GLsync &fence = fences[region];
+        if (fence == nullptr) return;
+
+        GLenum status = glClientWaitSync(fence, 0, 0);
+        if ((status != GL_ALREADY_SIGNALED) && (status != GL_CONDITION_SATISFIED)) {
+            ++stallCount;
+            constexpr GLuint64 timeout = 1'000'000'000; // Nanoseconds per attempt
+            do status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+            while (status == GL_TIMEOUT_EXPIRED);
+        }
+
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    uint32_t StreamingBuffer::getId() const noexcept {return id;}
+    size_t StreamingBuffer::getRegionSize() const noexcept {return regionSize;}
+    size_t StreamingBuffer::getStallCount() const noexcept {return stallCount;}
+
+    StreamingBuffer &StreamingBuffer::operator=(StreamingBuffer &&other) noexcept {
+        if (this != &other) {
+            destroy();
+            this->moveFrom(other);
+        }
+        return (*this);
+    }
+
+    StreamingBuffer::~StreamingBuffer() noexcept {destroy();}
+}
\ No newline at end of file
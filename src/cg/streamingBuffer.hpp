@@ -0,0 +1,49 @@
+#pragma once
+
+#include "_cgControl.hpp"
+
+namespace CG {
+    // Persistently mapped ring for data written by the CPU every frame. The buffer is split in 'regionCount' regions,
+    // each fenced when left, so the CPU only waits when it laps a region the GPU still reads from.
+    class StreamingBuffer {
+        public:
+            static constexpr size_t regionCount = 3; // Frames in flight
+            static constexpr size_t defaultAlignment = 16;
+
+            struct Allocation {
+                std::byte *data = nullptr; // Write only, coherent
+                size_t offset = 0;         // Into the buffer object
+            };
+
+        private:
+            uint32_t id = 0;
+            std::byte *mapped = nullptr;
+            size_t regionSize = 0;
+            std::array<GLsync, regionCount> fences = {};
+            size_t region = 0, offset = 0;
+            size_t stallCount = 0;
+
+            void clearFields() noexcept;
+            void moveFrom(StreamingBuffer &other) noexcept;
+            void destroy() noexcept;
+            void allocateStorage(size_t regionSize);
+
+        public:
+            StreamingBuffer() = delete;
+            explicit StreamingBuffer(size_t regionSize);
+            StreamingBuffer(const StreamingBuffer &) = delete;
+            StreamingBuffer(StreamingBuffer &&other) noexcept;
+
+            bool exists() const noexcept;
+            Allocation allocate(size_t size, size_t alignment = defaultAlignment); // In the current region, moving on when it's full and growing past requests bigger than a region
+            void nextRegion(); // Fences the current region and moves on, waiting if the GPU still reads the next one
+            uint32_t getId() const noexcept;
+            size_t getRegionSize() const noexcept;
+            size_t getStallCount() const noexcept; // Times 'nextRegion' had to wait on the GPU
+
+            StreamingBuffer &operator=(const StreamingBuffer &) = delete;
+            StreamingBuffer &operator=(StreamingBuffer &&other) noexcept;
+
+            ~StreamingBuffer() noexcept;
+    };
+}
\ No newline at end of file
@@ -1,10 +1,10 @@
+#include <atomic>
 #include "texture.hpp"
 #include "deleters.hpp"
+#include "window.hpp"
+#include "assetFile.hpp"
 
 namespace CG {
-    thread_local std::vector<uint32_t> Texture::slottedTextureIds = {};
-    thread_local std::unordered_map<uint32_t, int32_t> Texture::idToSlotMap = {};
-
     std::vector<uint8_t> Texture::verticallyFlip(const uint8_t *data, size_t width, size_t height, size_t channels) {
         std::vector<uint8_t> flippedPixels;
 
@@ -21,51 +21,88 @@ namespace CG {
         return flippedPixels;
     }
 
-    void Texture::clearFields() {
+    void Texture::clearFields() noexcept {
         id = 0;
         width = 0;
         height = 0;
         channels = 0;
-        wrapModeU = TextureWrapMode::Default;
-        wrapModeV = TextureWrapMode::Default;
-        minificationMode = TextureMinificationMode::Default;
-        magnificationMode = TextureMagnificationMode::Default;
+        samplerState = SamplerState();
+        samplerId = 0;
+        maxMipLevel = defaultMaxMipLevel;
+        unitBinding.clear();
     }
 
-    void Texture::moveFrom(Texture &other) {
+    void Texture::moveFrom(Texture &other) noexcept {
         if (this == &other) return;
 
         id = other.id;
         width = other.width;
         height = other.height;
         channels = other.channels;
-        wrapModeU = other.wrapModeU;
-        wrapModeV = other.wrapModeV;
-        minificationMode = other.minificationMode;
-        magnificationMode = other.magnificationMode;
+        samplerState = other.samplerState;
+        samplerId = other.samplerId;
+        maxMipLevel = other.maxMipLevel;
+        unitBinding = std::move(other.unitBinding);
 
         other.clearFields();
     }
 
-    void Texture::destroy() {
-        if (exists()) {
-            glDeleteTextures(1, &id);
+    void Texture::deleteObject() {
+        unitBinding.release(id); // Make sure no context thinks a unit still holds this id
+        // Handles can only be made non resident in the current context, the other windows' stay resident until their next frame
+        const Window *const current = Window::getCurrentContext();
+        for (const auto &window: Window::getInstances()) {
+            BindlessResidency *const residency = window->getBindlessResidency();
+            if (residency == nullptr) continue;
 
-            // Make sure this is not in slots
-            slottedTextureIds.erase(std::remove(slottedTextureIds.begin(), slottedTextureIds.end(), id), slottedTextureIds.end());
-            idToSlotMap.erase(id);
+            if (window == current) residency->release(id);
+            else residency->queueRelease(id);
         }
+        glDeleteTextures(1, &id);
+        id = 0;
+    }
 
+    void Texture::destroy() {
+        if (exists()) deleteObject();
         clearFields();
     }
 
+    void Texture::allocateStorage(size_t width, size_t height, size_t channels) {
+        // Immutable storage can't be resized or reformatted, that takes a new texture object. Deleting the old one unpins it, the new one takes the unit over.
+        const int32_t pinnedUnit = unitBinding.getPinnedUnit();
+        if (exists()) deleteObject();
+
+        const GLsizei mipLevelCount = static_cast<GLsizei>(std::bit_width(std::max(width, height)));
+
+        glCreateTextures(GL_TEXTURE_2D, 1, &id);
+        glTextureStorage2D(id, mipLevelCount, internalFormats[channels-1], width, height);
+        if (maxMipLevel != defaultMaxMipLevel) glTextureParameteri(id, GL_TEXTURE_MAX_LEVEL, maxMipLevel);
+
+        this->width = width;
+        this->height = height;
+        this->channels = channels;
+
+        if (pinnedUnit != TextureUnitAllocator::noUnit) unitBinding.pin(id, getSamplerId(), pinnedUnit);
+    }
+
+    uint32_t Texture::getSamplerId() const {
+        // Render threads may resolve it concurrently, they all store the same id
+        const std::atomic_ref<uint32_t> cachedId(samplerId);
+
+        uint32_t result = cachedId.load(std::memory_order_relaxed);
+        if (result == 0) {
+            result = Sampler::get(samplerState).getId();
+            cachedId.store(result, std::memory_order_relaxed);
+        }
+        return result;
+    }
+
     std::vector<uint8_t> Texture::calculatePixelsInternal(bool verticallyFlip) const {
         std::vector<uint8_t> result;
         result.resize((width * height * channels), 0);
 
-        glBindTexture(GL_TEXTURE_2D, id);
         glPixelStorei(GL_PACK_ALIGNMENT, 1);
-        glGetTexImage(GL_TEXTURE_2D, 0, (externalFormats[channels-1]), GL_UNSIGNED_BYTE, result.data());
+        glGetTextureImage(id, 0, (externalFormats[channels-1]), GL_UNSIGNED_BYTE, result.size(), result.data());
 
         if (verticallyFlip) return Texture::verticallyFlip(result.data(), width, height, channels);
         else return result;
@@ -74,10 +111,11 @@ namespace CG {
     void Texture::setPixelsInternal(const uint8_t *data, size_t width, size_t height, size_t channels, bool loadedFromFile, bool verticallyFlip) {
         ASSERT((channels > 0) && (channels <= 4));
 
-        const GLenum internalFormat = internalFormats[channels-1];
         const GLenum externalFormat = externalFormats[channels-1];
 
-        glBindTexture(GL_TEXTURE_2D, id);
+        if ((!exists()) || (width != this->width) || (height != this->height) || (channels != this->channels)) {
+            allocateStorage(width, height, channels);
+        }
 
         if (loadedFromFile) { // Loaded from STB image library, already aligned
             glPixelStorei(GL_UNPACK_ALIGNMENT, defaultAlignment);
@@ -92,38 +130,35 @@ namespace CG {
             data = flippedPixels.data();
         }
 
-        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, externalFormat, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        this->width = width;
-        this->height = height;
-        this->channels = channels;
+        glTextureSubImage2D(id, 0, 0, 0, width, height, externalFormat, GL_UNSIGNED_BYTE, data);
+        glGenerateTextureMipmap(id);
     }
 
     Texture::Texture(std::span<const uint8_t> data, size_t width, size_t height, size_t channels) {
-        glGenTextures(1, &this->id);
         this->setPixels(data, width, height, channels);
     }
 
     Texture::Texture(const std::filesystem::path &path) {
-        glGenTextures(1, &this->id);
-
-        stbi_set_flip_vertically_on_load(true);
+        const AssetFile file(path);
+        stbi_set_flip_vertically_on_load_thread(true);
 
         int width, height, channels;
-        const std::unique_ptr<uint8_t, LoadedImagePixelsDeleter> data(stbi_load(path.string().data(), &width, &height, &channels, 0));
+        const std::unique_ptr<uint8_t, LoadedImagePixelsDeleter> data(stbi_load_from_memory(
+            reinterpret_cast<const stbi_uc *>(file.getBytes().data()), static_cast<int>(file.getSize()), &width, &height, &channels, 0
+        ));
+        if (data == nullptr) throw std::runtime_error("Failed to decode \"" + path.string() + "\": " + stbi_failure_reason() + '\n' + std::to_string(std::stacktrace::current()));
 
         this->setPixelsInternal(data.get(), width, height, channels, true, false);
     }
 
-    Texture::Texture(const Texture &other) {
-        glGenTextures(1, &(this->id));
+    Texture::Texture(const Texture &other): samplerState(other.samplerState), maxMipLevel(other.maxMipLevel) {
         this->setPixelsInternal(other.calculatePixelsInternal(false).data(), other.width, other.height, other.channels, false, false);
     }
 
-    Texture::Texture(Texture &&other) {this->moveFrom(other);}
+    Texture::Texture(Texture &&other) noexcept {this->moveFrom(other);}
 
     bool Texture::exists() const noexcept {return (id != 0);}
+    uint32_t Texture::getId() const noexcept {return id;}
 
     std::vector<uint8_t> Texture::calculatePixels() const {
         return calculatePixelsInternal(true);
@@ -138,57 +173,82 @@ namespace CG {
     size_t Texture::getChannels() const noexcept {return channels;}
 
 
-    TextureWrapMode Texture::getWrapModeU() const noexcept {return wrapModeU;}
+    TextureWrapMode Texture::getWrapModeU() const noexcept {return samplerState.wrapModeU;}
 
     void Texture::setWrapModeU(TextureWrapMode value) {
-        glBindTexture(GL_TEXTURE_2D, id);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, static_cast<GLenum>(value));
-        wrapModeU = value;
+        samplerState.wrapModeU = value;
+        samplerId = 0;
     }
 
-    TextureWrapMode Texture::getWrapModeV() const noexcept {return wrapModeV;}
+    TextureWrapMode Texture::getWrapModeV() const noexcept {return samplerState.wrapModeV;}
 
     void Texture::setWrapModeV(TextureWrapMode value) {
-        glBindTexture(GL_TEXTURE_2D, id);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, static_cast<GLenum>(value));
-        wrapModeV = value;
+        samplerState.wrapModeV = value;
+        samplerId = 0;
     }
 
-    TextureMinificationMode Texture::getMinificationMode() const noexcept {return minificationMode;}
+    TextureMinificationMode Texture::getMinificationMode() const noexcept {return samplerState.minificationMode;}
 
     void Texture::setMinificationMode(TextureMinificationMode value) {
-        glBindTexture(GL_TEXTURE_2D, id);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, static_cast<GLenum>(value));
-        minificationMode = value;
+        samplerState.minificationMode = value;
+        samplerId = 0;
     }
 
-    TextureMagnificationMode Texture::getMagnificationMode() const noexcept {return magnificationMode;}
+    TextureMagnificationMode Texture::getMagnificationMode() const noexcept {return samplerState.magnificationMode;}
 
     void Texture::setMagnificationMode(TextureMagnificationMode value) {
-        glBindTexture(GL_TEXTURE_2D, id);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, static_cast<GLenum>(value));
-        magnificationMode = value;
+        samplerState.magnificationMode = value;
+        samplerId = 0;
     }
 
-    void Texture::slot(int32_t slotNumber) {
-        // Set texture to slot for each context
-        const auto windows = Window::getInstances();
-        for (size_t i = 0; i < windows.size(); ++i) {
-            windows[i]->makeContextCurrent();
-            glActiveTexture(GL_TEXTURE0 + slotNumber);
-            glBindTexture(GL_TEXTURE_2D, id);
-        }
+    float32_t Texture::getAnisotropy() const noexcept {return samplerState.anisotropy;}
+
+    void Texture::setAnisotropy(float32_t value) {
+        samplerState.anisotropy = value;
+        samplerId = 0;
+    }
 
-        if (std::cmp_less(slottedTextureIds.size(), (slotNumber+1))) slottedTextureIds.resize((slotNumber+1), 0); // Ensure minimum size.
-        slottedTextureIds[slotNumber] = id;
+    const SamplerState &Texture::getSamplerState() const noexcept {return samplerState;}
+
+    void Texture::setSamplerState(const SamplerState &value) {
+        samplerState = value;
+        samplerId = 0;
+    }
+
+    int32_t Texture::getMaxMipLevel() const noexcept {return maxMipLevel;}
+
+    void Texture::setMaxMipLevel(int32_t value) {
+        glTextureParameteri(id, GL_TEXTURE_MAX_LEVEL, value);
+        maxMipLevel = value;
+    }
 
-        idToSlotMap[id] = slotNumber;
+    void Texture::slot(int32_t slotNumber) {
+        unitBinding.pin(id, getSamplerId(), slotNumber);
     }
 
     int32_t Texture::getSlot() const {
-        const auto findSlot = idToSlotMap.find(this->id);
-        if (findSlot == idToSlotMap.end()) return noSlot;
-        else return findSlot->second;
+        return unitBinding.getUnit(id);
+    }
+
+    int32_t Texture::bind() const {
+        return unitBinding.bind(id, getSamplerId());
+    }
+
+    int32_t Texture::bind(const Sampler &sampler) const {
+        return unitBinding.bind(id, sampler.getId());
+    }
+
+    size_t Texture::calculateByteSize() const noexcept {
+        return (((width * height * channels) * 4) / 3);
+    }
+
+    GLuint64 Texture::getBindlessHandle() const {
+        const Window *const window = Window::getCurrentContext();
+        ASSERT(window != nullptr);
+
+        BindlessResidency *const residency = window->getBindlessResidency();
+        if (residency == nullptr) return noBindlessHandle;
+        return residency->acquire(id, getSamplerId(), calculateByteSize());
     }
 
     Texture &Texture::operator=(const Texture &other) {
@@ -197,7 +257,10 @@ namespace CG {
     }
 
     Texture &Texture::operator=(Texture &&other) {
-        this->moveFrom(other);
+        if (this != &other) {
+            destroy();
+            this->moveFrom(other);
+        }
         return (*this);
     }
 
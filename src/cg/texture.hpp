@@ -1,68 +1,57 @@
 #pragma once
 
 #include "_cgControl.hpp"
-#include "window.hpp"
+#include "textureUnits.hpp"
+#include "sampler.hpp"
 
 namespace CG {
-    enum class TextureWrapMode {
-        Default        = GL_REPEAT         ,
-        Repeat         = GL_REPEAT         ,
-        MirroredRepeat = GL_MIRRORED_REPEAT,
-        ClampToEdge    = GL_CLAMP_TO_EDGE  ,
-        ClampToBorder  = GL_CLAMP_TO_BORDER,
-    };
-
-    enum class TextureMinificationMode {
-        Default              = GL_LINEAR_MIPMAP_LINEAR  ,
-        Nearest              = GL_NEAREST               ,
-        Linear               = GL_LINEAR                ,
-        NearestMipmapNearest = GL_NEAREST_MIPMAP_NEAREST,
-        LinearMipmapNearest  = GL_LINEAR_MIPMAP_NEAREST ,
-        NearestMipmapLinear  = GL_NEAREST_MIPMAP_LINEAR ,
-        LinearMipmapLinear   = GL_LINEAR_MIPMAP_LINEAR
-    };
-
-    enum class TextureMagnificationMode {
-        Default = GL_LINEAR ,
-        Nearest = GL_NEAREST,
-        Linear  = GL_LINEAR ,
+    // Tightly packed pixels, top row first (same layout 'Texture::setPixels' takes)
+    struct TextureImage {
+        std::span<const uint8_t> data;
+        size_t width = 0, height = 0, channels = 0;
     };
 
 
     class Texture {
+        friend class TextureArray;
+
         private:
             static constexpr size_t defaultAlignment = 4;
             static constexpr std::array<GLenum, 4> internalFormats = {GL_R8 , GL_RG8, GL_RGB8, GL_RGBA8};
             static constexpr std::array<GLenum, 4> externalFormats = {GL_RED, GL_RG , GL_RGB , GL_RGBA };
 
-            static thread_local std::vector<uint32_t> slottedTextureIds; // Slot number to texture id.
-            static thread_local std::unordered_map<uint32_t, int32_t> idToSlotMap;
-
             static std::vector<uint8_t> verticallyFlip(const uint8_t *data, size_t width, size_t height, size_t channels);
 
             uint32_t id = 0;
             size_t width = 0, height = 0, channels = 0;
-            TextureWrapMode wrapModeU = TextureWrapMode::Default, wrapModeV = TextureWrapMode::Default;
-            TextureMinificationMode minificationMode = TextureMinificationMode::Default;
-            TextureMagnificationMode magnificationMode = TextureMagnificationMode::Default;
+            SamplerState samplerState;
+            mutable uint32_t samplerId = 0; // Resolved from the sampler cache on the next bind after 'samplerState' changes
+            int32_t maxMipLevel = defaultMaxMipLevel;
+            TextureUnitBinding unitBinding;
 
-            void clearFields();
-            void moveFrom(Texture &other);
+            void clearFields() noexcept;
+            void moveFrom(Texture &other) noexcept;
             void destroy();
+            void deleteObject();
+            void allocateStorage(size_t width, size_t height, size_t channels);
+            uint32_t getSamplerId() const;
 
             std::vector<uint8_t> calculatePixelsInternal(bool verticallyFlip) const;
             void setPixelsInternal(const uint8_t *data, size_t width, size_t height, size_t channels, bool loadedFromFile, bool verticallyFlip);
 
         public:
-            static constexpr int32_t noSlot = -1;
+            static constexpr int32_t noSlot = TextureUnitAllocator::noUnit;
+            static constexpr GLuint64 noBindlessHandle = 0;
+            static constexpr int32_t defaultMaxMipLevel = 1000; // GL default for GL_TEXTURE_MAX_LEVEL
 
             Texture() = delete;
             Texture(std::span<const uint8_t> data, size_t width, size_t height, size_t channels);
             explicit Texture(const std::filesystem::path &path);
             Texture(const Texture &other);
-            Texture(Texture &&other);
+            Texture(Texture &&other) noexcept; // Containers of textures move them rather than copying through a readback
 
             bool exists() const noexcept;
+            uint32_t getId() const noexcept; // GL texture name, small and stable until deleted, ex.: to sort draws by
             std::vector<uint8_t> calculatePixels() const;
             void setPixels(std::span<const uint8_t> data, size_t width, size_t height, size_t channels);
             size_t getWidth() const noexcept;
@@ -76,8 +65,18 @@ namespace CG {
             void setMinificationMode(TextureMinificationMode value);
             TextureMagnificationMode getMagnificationMode() const noexcept;
             void setMagnificationMode(TextureMagnificationMode value);
+            float32_t getAnisotropy() const noexcept;
+            void setAnisotropy(float32_t value);
+            const SamplerState &getSamplerState() const noexcept;
+            void setSamplerState(const SamplerState &value);
+            int32_t getMaxMipLevel() const noexcept;
+            void setMaxMipLevel(int32_t value);
             void slot(int32_t slotNumber);
             int32_t getSlot() const;
+            int32_t bind() const;
+            int32_t bind(const Sampler &sampler) const; // Same texture, sampled differently, without touching its own state. Get 'sampler' once, not per bind.
+            size_t calculateByteSize() const noexcept; // Including the mip chain
+            GLuint64 getBindlessHandle() const;         // Resident in the current context, sampled with this texture's sampler state. 'noBindlessHandle' without GL_ARB_bindless_texture, use 'bind' then.
 
             Texture &operator=(const Texture &other);
             Texture &operator=(Texture &&other);
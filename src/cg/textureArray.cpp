@@ -0,0 +1,119 @@
+#include "textureArray.hpp"
+
+namespace CG {
+    void TextureArray::clearFields() {
+        id = 0;
+        width = 0;
+        height = 0;
+        channels = 0;
+        layerCount = 0;
+        samplerState = SamplerState();
+        samplerId = 0;
+        unitBinding.clear();
+    }
+
+    void TextureArray::moveFrom(TextureArray &other) {
+        if (this == &other) return;
+
+        id = other.id;
+        width = other.width;
+        height = other.height;
+        channels = other.channels;
+        layerCount = other.layerCount;
+        samplerState = other.samplerState;
+        samplerId = other.samplerId;
+        unitBinding = std::move(other.unitBinding);
+
+        other.clearFields();
+    }
+
+    void TextureArray::destroy() {
+        if (exists()) {
+            unitBinding.release(id);
+            glDeleteTextures(1, &id);
+        }
+        clearFields();
+    }
+
+    TextureArray::TextureArray(std::span<const TextureImage> layers) {
+        ASSERT(!layers.empty());
+        ASSERT((layers[0].channels > 0) && (layers[0].channels <= 4));
+
+        this->width = layers[0].width;
+        this->height = layers[0].height;
+        this->channels = layers[0].channels;
+        this->layerCount = layers.size();
+
+        const GLsizei mipLevelCount = static_cast<GLsizei>(std::bit_width(std::max(width, height)));
+
+        glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &this->id);
+        glTextureStorage3D(this->id, mipLevelCount, Texture::internalFormats[channels-1], width, height, layerCount);
+
+        for (size_t i = 0; i < layers.size(); ++i) this->uploadLayer(i, layers[i]);
+        glGenerateTextureMipmap(id);
+    }
+
+    TextureArray::TextureArray(TextureArray &&other) {this->moveFrom(other);}
+
+    bool TextureArray::exists() const noexcept {return (id != 0);}
+    size_t TextureArray::getWidth() const noexcept {return width;}
+    size_t TextureArray::getHeight() const noexcept {return height;}
+    size_t TextureArray::getChannels() const noexcept {return channels;}
+    size_t TextureArray::getLayerCount() const noexcept {return layerCount;}
+
+    void TextureArray::setLayer(size_t layer, const TextureImage &image) {
+        uploadLayer(layer, image);
+        glGenerateTextureMipmap(id);
+    }
+
+    void TextureArray::uploadLayer(size_t layer, const TextureImage &image) {
+        ASSERT(layer < layerCount);
+        ASSERT((image.width == width) && (image.height == height) && (image.channels == channels));
+
+        const std::vector<uint8_t> flippedPixels = Texture::verticallyFlip(image.data.data(), width, height, channels);
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTextureSubImage3D(id, 0, 0, 0, layer, width, height, 1, Texture::externalFormats[channels-1], GL_UNSIGNED_BYTE, flippedPixels.data());
+    }
+
+    uint32_t TextureArray::getSamplerId() const {
+        // Render threads may resolve it concurrently, they all store the same id
+        const std::atomic_ref<uint32_t> cachedId(samplerId);
+
+        uint32_t result = cachedId.load(std::memory_order_relaxed);
+        if (result == 0) {
+            result = Sampler::get(samplerState).getId();
+            cachedId.store(result, std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+    const SamplerState &TextureArray::getSamplerState() const noexcept {return samplerState;}
+
+    void TextureArray::setSamplerState(const SamplerState &value) {
+        samplerState = value;
+        samplerId = 0;
+    }
+
+    void TextureArray::slot(int32_t slotNumber) {
+        unitBinding.pin(id, getSamplerId(), slotNumber);
+    }
+
+    int32_t TextureArray::getSlot() const {
+        return unitBinding.getUnit(id);
+    }
+
+    int32_t TextureArray::bind() const {
+        return unitBinding.bind(id, getSamplerId());
+    }
+
+    TextureArray &TextureArray::operator=(TextureArray &&other) {
+        if (this != &other) {
+            destroy();
+            this->moveFrom(other);
+        }
+        return (*this);
+    }
+
+    TextureArray::~TextureArray() noexcept {destroy();}
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "_cgControl.hpp"
+#include "texture.hpp"
+
+namespace CG {
+    // GL_TEXTURE_2D_ARRAY of same sized images. Each image becomes the layer with its index, so shaders pick it with 'texture(map, vec3(uv, layer))'.
+    class TextureArray {
+        private:
+            uint32_t id = 0;
+            size_t width = 0, height = 0, channels = 0, layerCount = 0;
+            SamplerState samplerState;
+            mutable uint32_t samplerId = 0; // Resolved from the sampler cache on the next bind after 'samplerState' changes
+            TextureUnitBinding unitBinding;
+
+            void clearFields();
+            void moveFrom(TextureArray &other);
+            void destroy();
+            void uploadLayer(size_t layer, const TextureImage &image);
+            uint32_t getSamplerId() const;
+
+        public:
+            TextureArray() = delete;
+            explicit TextureArray(std::span<const TextureImage> layers);
+            TextureArray(const TextureArray &) = delete;
+            TextureArray(TextureArray &&other);
+
+            bool exists() const noexcept;
+            size_t getWidth() const noexcept;
+            size_t getHeight() const noexcept;
+            size_t getChannels() const noexcept;
+            size_t getLayerCount() const noexcept;
+            void setLayer(size_t layer, const TextureImage &image);
+            const SamplerState &getSamplerState() const noexcept;
+            void setSamplerState(const SamplerState &value);
+            void slot(int32_t slotNumber);
+            int32_t getSlot() const;
+            int32_t bind() const;
+
+            TextureArray &operator=(const TextureArray &) = delete;
+            TextureArray &operator=(TextureArray &&other);
+
+            ~TextureArray() noexcept;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,197 @@
+#include "textureAtlas.hpp"
+
+namespace CG {
+    Vector2 TextureAtlasRegion::apply(const Vector2 &uv) const noexcept {
+        return (uvOffset + vectorScale(uv, uvScale));
+    }
+
+    void TextureAtlasRegion::applyTo(std::span<Vertex> vertices) const noexcept {
+        for (auto &vertex: vertices) vertex.uv = apply(vertex.uv);
+    }
+
+    Vector4 TextureAtlasRegion::asVector4() const noexcept {
+        return Vector4(uvOffset.x, uvOffset.y, uvScale.x, uvScale.y);
+    }
+
+
+    TextureAtlas::PackedAtlas TextureAtlas::buildAtlas(std::span<const TextureImage> images, size_t padding, size_t maxSize) {
+        ASSERT(!images.empty());
+
+        const size_t channels = images[0].channels;
+
+        // A gutter of 'padding' texels stays bleed free down to mip level log2(padding), as long as every rect starts aligned to that level
+        const int32_t safeMipLevel = ((padding == 0)? 0:static_cast<int32_t>(std::bit_width(padding) - 1));
+        const size_t alignment = (static_cast<size_t>(1) << safeMipLevel);
+
+        std::vector<TextureAtlasRect> paddedSizes;
+        paddedSizes.reserve(images.size());
+        size_t totalArea = 0, widest = 0, tallest = 0;
+        for (const auto &image: images) {
+            ASSERT(image.channels == channels);
+            ASSERT((image.width > 0) && (image.height > 0));
+
+            const size_t width  = ((((image.width  + (2 * padding)) + alignment - 1) / alignment) * alignment);
+            const size_t height = ((((image.height + (2 * padding)) + alignment - 1) / alignment) * alignment);
+            paddedSizes.push_back({0, 0, width, height});
+
+            totalArea += (width * height);
+            widest = std::max(widest, width);
+            tallest = std::max(tallest, height);
+        }
+
+        // Grow a power of two atlas until everything fits
+        size_t atlasWidth  = std::bit_ceil(std::max(widest , static_cast<size_t>(std::sqrt(static_cast<double>(totalArea)))));
+        size_t atlasHeight = std::bit_ceil(tallest);
+        while ((atlasWidth * atlasHeight) < totalArea) atlasHeight *= 2;
+
+        std::optional<std::vector<TextureAtlasRect>> rects;
+        while (!(rects = pack(paddedSizes, atlasWidth, atlasHeight)).has_value()) {
+            if (atlasWidth <= atlasHeight) atlasWidth *= 2;
+            else atlasHeight *= 2;
+
+            if ((atlasWidth > maxSize) || (atlasHeight > maxSize)) {
+                throw std::runtime_error("Texture atlas images don't fit in " + std::to_string(maxSize) + 'x' + std::to_string(maxSize) + ":\n" + std::to_string(std::stacktrace::current()));
+            }
+        }
+
+        PackedAtlas result;
+        result.width = atlasWidth;
+        result.height = atlasHeight;
+        result.channels = channels;
+        result.maxMipLevel = safeMipLevel;
+        result.pixels.resize((atlasWidth * atlasHeight * channels), 0);
+        result.regions.reserve(images.size());
+
+        for (size_t i = 0; i < images.size(); ++i) {
+            const TextureAtlasRect &rect = (*rects)[i];
+            const TextureImage &image = images[i];
+
+            blitWithGutter(result.pixels, atlasWidth, image, rect, padding);
+
+            // Texture uploads flip rows, so V is measured from the bottom of the atlas
+            const size_t imageTop = (rect.y + padding);
+            TextureAtlasRegion region;
+            region.uvOffset = Vector2(
+                (static_cast<float32_t>(rect.x + padding) / atlasWidth),
+                (static_cast<float32_t>(atlasHeight - (imageTop + image.height)) / atlasHeight)
+            );
+            region.uvScale = Vector2(
+                (static_cast<float32_t>(image.width) / atlasWidth),
+                (static_cast<float32_t>(image.height) / atlasHeight)
+            );
+            result.regions.push_back(region);
+        }
+
+        return result;
+    }
+
+    void TextureAtlas::blitWithGutter(std::vector<uint8_t> &atlasPixels, size_t atlasWidth, const TextureImage &image, const TextureAtlasRect &rect, size_t padding) {
+        const size_t channels = image.channels;
+
+        // Gutter texels repeat the closest edge texel, so filtering near the border never picks up a neighbour
+        for (size_t y = 0; y < rect.height; ++y) {
+            const size_t sourceY = static_cast<size_t>(std::clamp<ptrdiff_t>((static_cast<ptrdiff_t>(y) - static_cast<ptrdiff_t>(padding)), 0, static_cast<ptrdiff_t>(image.height - 1)));
+            uint8_t *const destinationRow = &atlasPixels[(((rect.y + y) * atlasWidth) + rect.x) * channels];
+            const uint8_t *const sourceRow = &image.data[sourceY * image.width * channels];
+
+            for (size_t x = 0; x < rect.width; ++x) {
+                const size_t sourceX = static_cast<size_t>(std::clamp<ptrdiff_t>((static_cast<ptrdiff_t>(x) - static_cast<ptrdiff_t>(padding)), 0, static_cast<ptrdiff_t>(image.width - 1)));
+                std::copy_n(&sourceRow[sourceX * channels], channels, &destinationRow[x * channels]);
+            }
+        }
+    }
+
+    std::optional<std::vector<TextureAtlasRect>> TextureAtlas::pack(std::span<const TextureAtlasRect> sizes, size_t atlasWidth, size_t atlasHeight) {
+        struct SkylineNode {
+            size_t x, y, width;
+        };
+
+        std::vector<SkylineNode> skyline = {{0, 0, atlasWidth}};
+        std::vector<TextureAtlasRect> result(sizes.size());
+
+        // Tallest first packs noticeably tighter
+        std::vector<size_t> order(sizes.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            if (sizes[a].height != sizes[b].height) return (sizes[a].height > sizes[b].height);
+            return (sizes[a].width > sizes[b].width);
+        });
+
+        for (const size_t index: order) {
+            const size_t width = sizes[index].width;
+            const size_t height = sizes[index].height;
+            ASSERT(width > 0);
+
+            size_t bestNode = skyline.size();
+            size_t bestY = std::numeric_limits<size_t>::max();
+            size_t bestNodeWidth = std::numeric_limits<size_t>::max();
+
+            for (size_t i = 0; i < skyline.size(); ++i) {
+                if ((skyline[i].x + width) > atlasWidth) break;
+
+                // Rect rests on the highest node under its span
+                size_t y = 0;
+                for (size_t j = i, covered = 0; covered < width; ++j) {
+                    y = std::max(y, skyline[j].y);
+                    covered += skyline[j].width;
+                }
+
+                if ((y + height) > atlasHeight) continue;
+                if ((y < bestY) || ((y == bestY) && (skyline[i].width < bestNodeWidth))) {
+                    bestNode = i;
+                    bestY = y;
+                    bestNodeWidth = skyline[i].width;
+                }
+            }
+
+            if (bestNode == skyline.size()) return std::nullopt;
+
+            const size_t x = skyline[bestNode].x;
+            const size_t end = (x + width);
+            result[index] = {x, bestY, width, height};
+
+            // Raise the skyline over the new rect, trimming whatever it covers
+            skyline.insert((skyline.begin() + bestNode), {x, (bestY + height), width});
+            for (size_t i = (bestNode + 1); i < skyline.size();) {
+                const size_t nodeEnd = (skyline[i].x + skyline[i].width);
+
+                if (skyline[i].x >= end) break;
+                else if (nodeEnd <= end) skyline.erase(skyline.begin() + i);
+                else {
+                    skyline[i].width = (nodeEnd - end);
+                    skyline[i].x = end;
+                    break;
+                }
+            }
+
+            for (size_t i = 0; (i + 1) < skyline.size();) {
+                if (skyline[i].y == skyline[i + 1].y) {
+                    skyline[i].width += skyline[i + 1].width;
+                    skyline.erase(skyline.begin() + (i + 1));
+                }
+                else ++i;
+            }
+        }
+
+        return result;
+    }
+
+    TextureAtlas::TextureAtlas(PackedAtlas &&packed):
+        texture(packed.pixels, packed.width, packed.height, packed.channels),
+        regions(std::move(packed.regions)) {
+        texture.setMaxMipLevel(packed.maxMipLevel);
+    }
+
+    TextureAtlas::TextureAtlas(std::span<const TextureImage> images, size_t padding, size_t maxSize):
+        TextureAtlas(buildAtlas(images, padding, maxSize)) {}
+
+    const Texture &TextureAtlas::getTexture() const noexcept {return texture;}
+    Texture &TextureAtlas::getTexture() noexcept {return texture;}
+
+    const TextureAtlasRegion &TextureAtlas::getRegion(size_t imageIndex) const {
+        ASSERT(imageIndex < regions.size());
+        return regions[imageIndex];
+    }
+
+    std::span<const TextureAtlasRegion> TextureAtlas::getRegions() const noexcept {return regions;}
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "_cgControl.hpp"
+#include "texture.hpp"
+#include "vertex.hpp"
+
+namespace CG {
+    // Pixel rectangle inside the atlas, top row first
+    struct TextureAtlasRect {
+        size_t x = 0, y = 0, width = 0, height = 0;
+    };
+
+    // Maps an image's own [0, 1] UVs into the part of the atlas it was packed in
+    struct TextureAtlasRegion {
+        Vector2 uvOffset = Vector2::zero;
+        Vector2 uvScale = Vector2::one;
+
+        Vector2 apply(const Vector2 &uv) const noexcept;
+        void applyTo(std::span<Vertex> vertices) const noexcept;
+        Vector4 asVector4() const noexcept; // (offset.x, offset.y, scale.x, scale.y), for per instance data
+    };
+
+
+    class TextureAtlas {
+        private:
+            struct PackedAtlas {
+                std::vector<uint8_t> pixels;
+                size_t width = 0, height = 0, channels = 0;
+                int32_t maxMipLevel = 0;
+                std::vector<TextureAtlasRegion> regions;
+            };
+
+            Texture texture;
+            std::vector<TextureAtlasRegion> regions;
+
+            static PackedAtlas buildAtlas(std::span<const TextureImage> images, size_t padding, size_t maxSize);
+            static void blitWithGutter(std::vector<uint8_t> &atlasPixels, size_t atlasWidth, const TextureImage &image, const TextureAtlasRect &rect, size_t padding);
+
+            explicit TextureAtlas(PackedAtlas &&packed);
+
+        public:
+            static constexpr size_t defaultPadding = 4;
+            static constexpr size_t defaultMaxSize = 4096;
+
+            // Skyline packing, lowest fit first. Returns one rect per size, in the same order, or nullopt if they don't fit.
+            static std::optional<std::vector<TextureAtlasRect>> pack(std::span<const TextureAtlasRect> sizes, size_t atlasWidth, size_t atlasHeight);
+
+            TextureAtlas() = delete;
+            explicit TextureAtlas(std::span<const TextureImage> images, size_t padding = defaultPadding, size_t maxSize = defaultMaxSize);
+            TextureAtlas(const TextureAtlas &) = default;
+            TextureAtlas(TextureAtlas &&) = default;
+
+            const Texture &getTexture() const noexcept;
+            Texture &getTexture() noexcept;
+            const TextureAtlasRegion &getRegion(size_t imageIndex) const;
+            std::span<const TextureAtlasRegion> getRegions() const noexcept;
+
+            TextureAtlas &operator=(const TextureAtlas &) = default;
+            TextureAtlas &operator=(TextureAtlas &&) = default;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,226 @@
+#include "textureStreaming.hpp"
+
+namespace CG {
+    size_t TextureStreamer::calculateByteSize(size_t width, size_t height, size_t channels, int32_t mip) noexcept {
+        const int32_t levelCount = static_cast<int32_t>(std::bit_width(std::max(width, height)));
+
+        size_t result = 0;
+        for (int32_t level = mip; level < levelCount; ++level) {
+            result += (std::max<size_t>((width >> level), 1) * std::max<size_t>((height >> level), 1) * channels);
+        }
+
+        return result;
+    }
+
+    float32_t TextureStreamer::calculateScreenDiameter(const StreamingBounds &bounds, const Matrix4 &viewMatrix, const Matrix4 &projectionMatrix, float32_t viewportHeight) noexcept {
+        const Vector4 viewPosition = (viewMatrix * Vector4(bounds.center.x, bounds.center.y, bounds.center.z, 1.0f));
+        const float32_t depth = -viewPosition.z; // The camera looks down -Z
+
+        if (depth < -bounds.radius) return 0.0f;                                              // Entirely behind the camera
+        if (depth <= bounds.radius) return std::numeric_limits<float32_t>::infinity();       // Camera inside the bounds
+
+        // at(1, 1) is cot(fovY / 2), the NDC height of one unit at distance one
+        return ((bounds.radius * projectionMatrix.at(1, 1) * viewportHeight) / depth);
+    }
+
+    std::vector<uint8_t> TextureStreamer::downsample(std::span<const uint8_t> pixels, size_t width, size_t height, size_t channels, int32_t mip) {
+        std::vector<uint8_t> result(pixels.begin(), pixels.end());
+
+        // 2x2 box filter per level, odd edges repeat their last texel
+        for (int32_t level = 0; level < mip; ++level) {
+            const size_t halfWidth = std::max<size_t>((width / 2), 1);
+            const size_t halfHeight = std::max<size_t>((height / 2), 1);
+            std::vector<uint8_t> half(halfWidth * halfHeight * channels);
+
+            for (size_t y = 0; y < halfHeight; ++y) {
+                const size_t y0 = std::min((y * 2), (height - 1)), y1 = std::min(((y * 2) + 1), (height - 1));
+                for (size_t x = 0; x < halfWidth; ++x) {
+                    const size_t x0 = std::min((x * 2), (width - 1)), x1 = std::min(((x * 2) + 1), (width - 1));
+                    for (size_t c = 0; c < channels; ++c) {
+                        const uint32_t sum =
+                            result[(((y0 * width) + x0) * channels) + c] + result[(((y0 * width) + x1) * channels) + c] +
+                            result[(((y1 * width) + x0) * channels) + c] + result[(((y1 * width) + x1) * channels) + c];
+                        half[(((y * halfWidth) + x) * channels) + c] = static_cast<uint8_t>((sum + 2) / 4);
+                    }
+                }
+            }
+
+            result = std::move(half);
+            width = halfWidth;
+            height = halfHeight;
+        }
+
+        return result;
+    }
+
+    int32_t TextureStreamer::calculateTailMip(size_t width, size_t height) noexcept {
+        const size_t largest = std::max(width, height);
+
+        int32_t result = 0;
+        while ((largest >> result) > tailSize) ++result;
+        return result;
+    }
+
+    void TextureStreamer::setResidentMip(Entry &entry, int32_t mip) {
+        const std::vector<uint8_t> pixels = downsample(entry.pixels, entry.width, entry.height, entry.channels, mip);
+        entry.texture.setPixels(pixels, std::max<size_t>((entry.width >> mip), 1), std::max<size_t>((entry.height >> mip), 1), entry.channels);
+        entry.residentMip = mip;
+    }
+
+    TextureStreamer::TextureStreamer(size_t budget, size_t uploadBytesPerFrame):
+        budget(budget), uploadBytesPerFrame(uploadBytesPerFrame) {}
+
+    size_t TextureStreamer::add(std::vector<uint8_t> &&pixels, size_t width, size_t height, size_t channels) {
+        ASSERT(pixels.size() == (width * height * channels));
+
+        const int32_t tailMip = calculateTailMip(width, height);
+
+        const std::vector<uint8_t> tail = downsample(pixels, width, height, channels, tailMip);
+        entries.push_back({
+            std::move(pixels), width, height, channels,
+            Texture(tail, std::max<size_t>((width >> tailMip), 1), std::max<size_t>((height >> tailMip), 1), channels),
+            tailMip, tailMip, tailMip, 0
+        });
+
+        residentBytes += calculateByteSize(width, height, channels, tailMip);
+        return (entries.size() - 1);
+    }
+
+    Texture &TextureStreamer::getTexture(size_t index) {
+        ASSERT(index < entries.size());
+        return entries[index].texture;
+    }
+
+    const Texture &TextureStreamer::getTexture(size_t index) const {
+        ASSERT(index < entries.size());
+        return entries[index].texture;
+    }
+
+    int32_t TextureStreamer::getResidentMip(size_t index) const {
+        ASSERT(index < entries.size());
+        return entries[index].residentMip;
+    }
+
+    size_t TextureStreamer::getCount() const noexcept {return entries.size();}
+
+    void TextureStreamer::beginFrame() noexcept {
+        ++frame;
+        frameLoadCount = 0;
+        frameEvictionCount = 0;
+    }
+
+    void TextureStreamer::request(size_t index, int32_t mip) {
+        ASSERT(index < entries.size());
+        Entry &entry = entries[index];
+
+        mip = std::clamp(mip, 0, calculateTailMip(entry.width, entry.height));
+        if (entry.lastRequestedFrame != frame) entry.requestedMip = mip;
+        else entry.requestedMip = std::min(entry.requestedMip, mip);
+        entry.lastRequestedFrame = frame;
+    }
+
+    void TextureStreamer::request(size_t index, const StreamingBounds &bounds, const Matrix4 &viewMatrix, const Matrix4 &projectionMatrix, float32_t viewportHeight) {
+        ASSERT(index < entries.size());
+        const Entry &entry = entries[index];
+
+        const float32_t diameter = calculateScreenDiameter(bounds, viewMatrix, projectionMatrix, viewportHeight);
+        if (diameter <= 0.0f) return; // Not visible, left to the budget to evict
+
+        // One texel per pixel across the object
+        const float32_t texelsPerPixel = (static_cast<float32_t>(std::max(entry.width, entry.height)) / diameter);
+        const float32_t mip = ((texelsPerPixel <= 1.0f)? 0.0f:std::log2(texelsPerPixel)) + mipBias;
+
+        request(index, static_cast<int32_t>(std::clamp(std::floor(mip), 0.0f, static_cast<float32_t>(calculateTailMip(entry.width, entry.height)))));
+    }
+
+    void TextureStreamer::update() {
+        // Requested textures want their mip, the rest keep what they have until the budget needs it
+        size_t targetBytes = 0;
+        for (auto &entry: entries) {
+            entry.targetMip = ((entry.lastRequestedFrame == frame)? entry.requestedMip:entry.residentMip);
+            targetBytes += calculateByteSize(entry.width, entry.height, entry.channels, entry.targetMip);
+        }
+
+        // Over budget: drop one top mip at a time, least recently requested first, then biggest first
+        if (targetBytes > budget) {
+            const auto lessUrgent = [this](size_t a, size_t b) {
+                const Entry &entryA = entries[a], &entryB = entries[b];
+                if (entryA.lastRequestedFrame != entryB.lastRequestedFrame) return (entryA.lastRequestedFrame > entryB.lastRequestedFrame);
+                return (calculateByteSize(entryA.width, entryA.height, entryA.channels, entryA.targetMip) < calculateByteSize(entryB.width, entryB.height, entryB.channels, entryB.targetMip));
+            };
+
+            std::priority_queue<size_t, std::vector<size_t>, decltype(lessUrgent)> victims(lessUrgent);
+            for (size_t i = 0; i < entries.size(); ++i) {
+                if (entries[i].targetMip < calculateTailMip(entries[i].width, entries[i].height)) victims.push(i);
+            }
+
+            while ((targetBytes > budget) && !victims.empty()) {
+                const size_t index = victims.top();
+                victims.pop();
+
+                Entry &entry = entries[index];
+                targetBytes -= calculateByteSize(entry.width, entry.height, entry.channels, entry.targetMip);
+                ++entry.targetMip;
+                targetBytes += calculateByteSize(entry.width, entry.height, entry.channels, entry.targetMip);
+
+                if (entry.targetMip < calculateTailMip(entry.width, entry.height)) victims.push(index);
+            }
+        }
+
+        // Evictions apply right away, they only free memory
+        for (auto &entry: entries) {
+            if (entry.targetMip <= entry.residentMip) continue;
+
+            residentBytes -= calculateByteSize(entry.width, entry.height, entry.channels, entry.residentMip);
+            setResidentMip(entry, entry.targetMip);
+            residentBytes += calculateByteSize(entry.width, entry.height, entry.channels, entry.residentMip);
+            ++frameEvictionCount;
+        }
+
+        // Loads are limited per frame, the textures furthest from their target go first
+        std::vector<size_t> loads;
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (entries[i].targetMip < entries[i].residentMip) loads.push_back(i);
+        }
+        std::sort(loads.begin(), loads.end(), [this](size_t a, size_t b) {
+            return ((entries[a].residentMip - entries[a].targetMip) > (entries[b].residentMip - entries[b].targetMip));
+        });
+
+        size_t uploadBytesLeft = uploadBytesPerFrame;
+        pendingLoadCount = 0;
+        for (const size_t index: loads) {
+            Entry &entry = entries[index];
+
+            // Finest mip that still fits this frame, the first load always goes through so a huge mip can't stall forever
+            int32_t mip = entry.targetMip;
+            const auto uploadBytes = [&entry](int32_t mip) {
+                return (std::max<size_t>((entry.width >> mip), 1) * std::max<size_t>((entry.height >> mip), 1) * entry.channels);
+            };
+            if (frameLoadCount > 0) {
+                while ((mip < entry.residentMip) && (uploadBytes(mip) > uploadBytesLeft)) ++mip;
+            }
+
+            if (mip < entry.residentMip) {
+                uploadBytesLeft -= std::min(uploadBytesLeft, uploadBytes(mip));
+                residentBytes -= calculateByteSize(entry.width, entry.height, entry.channels, entry.residentMip);
+                setResidentMip(entry, mip);
+                residentBytes += calculateByteSize(entry.width, entry.height, entry.channels, entry.residentMip);
+                ++frameLoadCount;
+            }
+
+            if (entry.targetMip < entry.residentMip) ++pendingLoadCount;
+        }
+    }
+
+    size_t TextureStreamer::getBudget() const noexcept {return budget;}
+    void TextureStreamer::setBudget(size_t value) {budget = value;}
+    size_t TextureStreamer::getUploadBytesPerFrame() const noexcept {return uploadBytesPerFrame;}
+    void TextureStreamer::setUploadBytesPerFrame(size_t value) {uploadBytesPerFrame = value;}
+    float32_t TextureStreamer::getMipBias() const noexcept {return mipBias;}
+    void TextureStreamer::setMipBias(float32_t value) {mipBias = value;}
+
+    size_t TextureStreamer::getResidentBytes() const noexcept {return residentBytes;}
+    size_t TextureStreamer::getPendingLoadCount() const noexcept {return pendingLoadCount;}
+    size_t TextureStreamer::getFrameLoadCount() const noexcept {return frameLoadCount;}
+    size_t TextureStreamer::getFrameEvictionCount() const noexcept {return frameEvictionCount;}
+}
\ No newline at end of file
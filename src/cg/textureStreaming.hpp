@@ -0,0 +1,80 @@
+#pragma once
+
+#include <deque>
+#include "_cgControl.hpp"
+#include "texture.hpp"
+
+namespace CG {
+    // World space bounding sphere
+    struct StreamingBounds {
+        Vector3 center = Vector3::zero;
+        float32_t radius = 0.0f;
+    };
+
+
+    // Keeps the full resolution pixels of each texture in system memory and only the mips the screen needs on the GPU, within a byte budget.
+    // A texture streamed at mip N is a texture of size (width >> N, height >> N), so dropping top mips really frees the memory.
+    class TextureStreamer {
+        private:
+            struct Entry {
+                std::vector<uint8_t> pixels; // Full resolution, top row first
+                size_t width = 0, height = 0, channels = 0;
+                Texture texture;
+                int32_t residentMip = 0;
+                int32_t targetMip = 0;
+                int32_t requestedMip = 0;        // Finest mip asked for this frame
+                uint64_t lastRequestedFrame = 0;
+            };
+
+            std::deque<Entry> entries; // Never reallocated, so references from 'getTexture' stay valid as textures are added
+            size_t budget = 0;
+            size_t uploadBytesPerFrame = 0;
+            float32_t mipBias = 0.0f;
+            uint64_t frame = 1;
+
+            size_t residentBytes = 0;
+            size_t pendingLoadCount = 0;
+            size_t frameLoadCount = 0;
+            size_t frameEvictionCount = 0;
+
+            static std::vector<uint8_t> downsample(std::span<const uint8_t> pixels, size_t width, size_t height, size_t channels, int32_t mip);
+            static int32_t calculateTailMip(size_t width, size_t height) noexcept;
+            void setResidentMip(Entry &entry, int32_t mip);
+
+        public:
+            static constexpr size_t defaultBudget = (static_cast<size_t>(256) << 20);
+            static constexpr size_t defaultUploadBytesPerFrame = (static_cast<size_t>(16) << 20);
+            static constexpr size_t tailSize = 64; // Mips this small or smaller never get evicted
+
+            static size_t calculateByteSize(size_t width, size_t height, size_t channels, int32_t mip) noexcept; // Mip and everything below it
+            static float32_t calculateScreenDiameter(const StreamingBounds &bounds, const Matrix4 &viewMatrix, const Matrix4 &projectionMatrix, float32_t viewportHeight) noexcept; // In pixels
+
+            TextureStreamer(size_t budget = defaultBudget, size_t uploadBytesPerFrame = defaultUploadBytesPerFrame);
+            TextureStreamer(const TextureStreamer &) = delete;
+
+            size_t add(std::vector<uint8_t> &&pixels, size_t width, size_t height, size_t channels); // Returns the texture's index, streamed in starting from its tail
+            Texture &getTexture(size_t index);
+            const Texture &getTexture(size_t index) const;
+            int32_t getResidentMip(size_t index) const;
+            size_t getCount() const noexcept;
+
+            void beginFrame() noexcept;
+            void request(size_t index, int32_t mip);                                                                                                   // Finest mip wins if requested more than once
+            void request(size_t index, const StreamingBounds &bounds, const Matrix4 &viewMatrix, const Matrix4 &projectionMatrix, float32_t viewportHeight); // Mip from the screen coverage of 'bounds'
+            void update(); // After the frame's requests: evicts under budget, then loads the finest missing mips first
+
+            size_t getBudget() const noexcept;
+            void setBudget(size_t value);
+            size_t getUploadBytesPerFrame() const noexcept;
+            void setUploadBytesPerFrame(size_t value);
+            float32_t getMipBias() const noexcept;
+            void setMipBias(float32_t value); // Added to every coverage based mip, positive trades sharpness for memory
+
+            size_t getResidentBytes() const noexcept;
+            size_t getPendingLoadCount() const noexcept;
+            size_t getFrameLoadCount() const noexcept;
+            size_t getFrameEvictionCount() const noexcept;
+
+            TextureStreamer &operator=(const TextureStreamer &) = delete;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,178 @@
+#include "textureUnits.hpp"
+#include "window.hpp"
+
+namespace CG {
+    std::vector<uint32_t> TextureUnitAllocator::freeIndices = {};
+    uint32_t TextureUnitAllocator::nextIndex = 0;
+
+    void TextureUnitAllocator::unlink(int32_t unit) noexcept {
+        Unit &u = units[unit];
+
+        if (u.previous != noUnit) units[u.previous].next = u.next;
+        else head = u.next;
+
+        if (u.next != noUnit) units[u.next].previous = u.previous;
+        else tail = u.previous;
+
+        u.previous = noUnit;
+        u.next = noUnit;
+    }
+
+    void TextureUnitAllocator::pushFront(int32_t unit) noexcept {
+        Unit &u = units[unit];
+
+        u.previous = noUnit;
+        u.next = head;
+        if (head != noUnit) units[head].previous = unit;
+        head = unit;
+        if (tail == noUnit) tail = unit;
+    }
+
+    void TextureUnitAllocator::assign(int32_t unit, uint32_t textureId, uint32_t samplerId) {
+        if (units[unit].textureId != textureId) {
+            units[unit].textureId = textureId;
+            glBindTextureUnit(static_cast<GLuint>(unit), textureId);
+        }
+        if (units[unit].samplerId != samplerId) {
+            units[unit].samplerId = samplerId;
+            glBindSampler(static_cast<GLuint>(unit), samplerId);
+        }
+    }
+
+    TextureUnitAllocator &TextureUnitAllocator::getCurrent() {
+        Window *const window = Window::getCurrentContext();
+        ASSERT(window != nullptr);
+        return window->getTextureUnits();
+    }
+
+    TextureUnitAllocator::TextureUnitAllocator() {
+        if (freeIndices.empty()) index = nextIndex++;
+        else {
+            index = freeIndices.back();
+            freeIndices.pop_back();
+        }
+
+        int32_t unitCount;
+        glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &unitCount);
+        ASSERT(unitCount > 0);
+
+        units.resize(static_cast<size_t>(unitCount));
+        for (int32_t i = (unitCount - 1); i >= 0; --i) pushFront(i);
+    }
+
+    uint32_t TextureUnitAllocator::getIndex() const noexcept {return index;}
+
+    size_t TextureUnitAllocator::getUnitCount() const noexcept {return units.size();}
+
+    bool TextureUnitAllocator::holds(int32_t unit, uint32_t textureId) const noexcept {
+        return ((unit >= 0) && (std::cmp_less(unit, units.size())) && (units[unit].textureId == textureId));
+    }
+
+    int32_t TextureUnitAllocator::bind(uint32_t textureId, uint32_t samplerId, int32_t unitHint) {
+        if (holds(unitHint, textureId)) {
+            if (!units[unitHint].pinned) {
+                unlink(unitHint);
+                pushFront(unitHint);
+            }
+            assign(unitHint, textureId, samplerId);
+            return unitHint;
+        }
+
+        ASSERT(tail != noUnit); // Every unit is pinned
+        const int32_t unit = tail;
+        unlink(unit);
+        pushFront(unit);
+        assign(unit, textureId, samplerId);
+        return unit;
+    }
+
+    void TextureUnitAllocator::bindPinned(uint32_t textureId, uint32_t samplerId, int32_t unit) {
+        ASSERT((unit >= 0) && (std::cmp_less(unit, units.size())));
+
+        if (!units[unit].pinned) {
+            unlink(unit);
+            units[unit].pinned = true;
+        }
+        assign(unit, textureId, samplerId);
+    }
+
+    void TextureUnitAllocator::release(uint32_t textureId, int32_t unitHint) noexcept {
+        const auto releaseUnit = [&](int32_t unit) {
+            units[unit].textureId = 0;
+            if (units[unit].pinned) units[unit].pinned = false;
+            else unlink(unit);
+
+            // Free units are reused first
+            units[unit].previous = tail;
+            units[unit].next = noUnit;
+            if (tail != noUnit) units[tail].next = unit;
+            tail = unit;
+            if (head == noUnit) head = unit;
+        };
+
+        if (holds(unitHint, textureId)) {
+            releaseUnit(unitHint);
+            return;
+        }
+
+        // Pinned units don't go through hints
+        for (int32_t unit = 0; std::cmp_less(unit, units.size()); ++unit) {
+            if (units[unit].textureId == textureId) releaseUnit(unit);
+        }
+    }
+
+    TextureUnitAllocator::~TextureUnitAllocator() noexcept {
+        freeIndices.push_back(index);
+    }
+
+
+    int32_t TextureUnitBinding::getHint(const TextureUnitAllocator &allocator) const noexcept {
+        const uint32_t index = allocator.getIndex();
+        return ((index < unitHints.size())? unitHints[index]:TextureUnitAllocator::noUnit);
+    }
+
+    int32_t TextureUnitBinding::bind(uint32_t textureId, uint32_t samplerId) const {
+        TextureUnitAllocator &allocator = TextureUnitAllocator::getCurrent();
+
+        if (pinnedUnit != TextureUnitAllocator::noUnit) {
+            allocator.bindPinned(textureId, samplerId, pinnedUnit);
+            return pinnedUnit;
+        }
+
+        const uint32_t index = allocator.getIndex();
+        if (index >= unitHints.size()) return allocator.bind(textureId, samplerId, TextureUnitAllocator::noUnit);
+
+        unitHints[index] = allocator.bind(textureId, samplerId, unitHints[index]);
+        return unitHints[index];
+    }
+
+    void TextureUnitBinding::pin(uint32_t textureId, uint32_t samplerId, int32_t unit) {
+        // Other contexts pick the pinned unit up the next time the texture is bound there
+        pinnedUnit = unit;
+        TextureUnitAllocator::getCurrent().bindPinned(textureId, samplerId, unit);
+    }
+
+    int32_t TextureUnitBinding::getUnit(uint32_t textureId) const {
+        if (pinnedUnit != TextureUnitAllocator::noUnit) return pinnedUnit;
+
+        const TextureUnitAllocator &allocator = TextureUnitAllocator::getCurrent();
+        const int32_t hint = getHint(allocator);
+        return (allocator.holds(hint, textureId)? hint:TextureUnitAllocator::noUnit);
+    }
+
+    int32_t TextureUnitBinding::getPinnedUnit() const noexcept {return pinnedUnit;}
+
+    void TextureUnitBinding::release(uint32_t textureId) noexcept {
+        // Only bookkeeping, no context is made current
+        for (const auto &window: Window::getInstances()) {
+            TextureUnitAllocator &allocator = window->getTextureUnits();
+            allocator.release(textureId, getHint(allocator));
+        }
+        clear();
+    }
+
+    void TextureUnitBinding::clear() noexcept {
+        pinnedUnit = TextureUnitAllocator::noUnit;
+        unitHints = makeEmptyHints();
+    }
+}
\ No newline at end of file
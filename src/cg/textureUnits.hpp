@@ -0,0 +1,74 @@
+#pragma once
+
+#include "_cgControl.hpp"
+
+namespace CG {
+    // Texture unit bookkeeping for one context. Units are handed out when something is bound for drawing, and the least recently used one is evicted once all are taken.
+    class TextureUnitAllocator {
+        private:
+            struct Unit {
+                uint32_t textureId = 0;
+                uint32_t samplerId = 0;
+                bool pinned = false;
+                int32_t previous = -1, next = -1; // LRU list, most recently used at the head
+            };
+
+            static std::vector<uint32_t> freeIndices;
+            static uint32_t nextIndex;
+
+            uint32_t index = 0;
+            std::vector<Unit> units;
+            int32_t head = -1, tail = -1;
+
+            void unlink(int32_t unit) noexcept;
+            void pushFront(int32_t unit) noexcept;
+            void assign(int32_t unit, uint32_t textureId, uint32_t samplerId);
+
+        public:
+            static constexpr int32_t noUnit = -1;
+
+            static TextureUnitAllocator &getCurrent(); // Allocator of the current context's window
+
+            TextureUnitAllocator(); // Queries the unit count of the current context
+            TextureUnitAllocator(const TextureUnitAllocator &) = delete;
+
+            uint32_t getIndex() const noexcept;
+            size_t getUnitCount() const noexcept;
+            bool holds(int32_t unit, uint32_t textureId) const noexcept;
+
+            int32_t bind(uint32_t textureId, uint32_t samplerId, int32_t unitHint);
+            void bindPinned(uint32_t textureId, uint32_t samplerId, int32_t unit);
+            void release(uint32_t textureId, int32_t unitHint) noexcept;
+
+            TextureUnitAllocator &operator=(const TextureUnitAllocator &) = delete;
+
+            ~TextureUnitAllocator() noexcept;
+    };
+
+
+    // What a texture object needs to find its unit in every context: an optional pinned unit, and one O(1) unit hint per allocator.
+    // Hints never reallocate, so render threads can each update their own context's hint. Contexts past 'maxHintedContexts' just don't get one.
+    class TextureUnitBinding {
+        private:
+            static constexpr size_t maxHintedContexts = 8;
+
+            int32_t pinnedUnit = TextureUnitAllocator::noUnit;
+            mutable std::array<int32_t, maxHintedContexts> unitHints = makeEmptyHints(); // Indexed by 'TextureUnitAllocator::getIndex'
+
+            static constexpr std::array<int32_t, maxHintedContexts> makeEmptyHints() noexcept {
+                std::array<int32_t, maxHintedContexts> result;
+                result.fill(TextureUnitAllocator::noUnit);
+                return result;
+            }
+
+            int32_t getHint(const TextureUnitAllocator &allocator) const noexcept;
+
+        public:
+            int32_t bind(uint32_t textureId, uint32_t samplerId) const;
+            void pin(uint32_t textureId, uint32_t samplerId, int32_t unit);
+            int32_t getUnit(uint32_t textureId) const;
+            int32_t getPinnedUnit() const noexcept; // 'TextureUnitAllocator::noUnit' if not pinned
+            void release(uint32_t textureId) noexcept;
+            void clear() noexcept;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,308 @@
+#include "transformHierarchy.hpp"
+#include "space.hpp"
+#include "profiler.hpp"
+#include "jobSystem.hpp"
+
+#if defined(__SSE__)
+    #include <immintrin.h>
+#endif
+
+namespace CG {
+    namespace {
+        // result = parent * local, both column major
+        void multiplyWorld(const Matrix4 &parent, const Matrix4 &local, Matrix4 &result) noexcept {
+            #if defined(__SSE__)
+                const float32_t *const a = &parent.at(0, 0);
+                const float32_t *const b = &local.at(0, 0);
+                float32_t *const out = &result.at(0, 0);
+
+                const __m128 col0 = _mm_loadu_ps(a), col1 = _mm_loadu_ps(a + 4), col2 = _mm_loadu_ps(a + 8), col3 = _mm_loadu_ps(a + 12);
+                for (size_t col = 0; col < 4; ++col) {
+                    const float32_t *const bCol = (b + (col * 4));
+                    __m128 sum = _mm_mul_ps(col0, _mm_set1_ps(bCol[0]));
+                    sum = _mm_add_ps(sum, _mm_mul_ps(col1, _mm_set1_ps(bCol[1])));
+                    sum = _mm_add_ps(sum, _mm_mul_ps(col2, _mm_set1_ps(bCol[2])));
+                    sum = _mm_add_ps(sum, _mm_mul_ps(col3, _mm_set1_ps(bCol[3])));
+                    _mm_storeu_ps((out + (col * 4)), sum);
+                }
+            #else
+                result = (parent * local);
+            #endif
+        }
+    }
+
+    uint32_t TransformHierarchy::getIndex(TransformId id) const {
+        if (!exists(id)) throw std::invalid_argument("Unknown transform id " + std::to_string(id.index) + ":\n" + std::to_string(std::stacktrace::current()));
+        return indices[id.index];
+    }
+
+    void TransformHierarchy::markDirty(uint32_t index) noexcept {
+        dirty[index] = true;
+        for (uint32_t i = index; (i != noParent) && !subtreeDirty[i]; i = parents[i]) subtreeDirty[i] = true;
+    }
+
+    void TransformHierarchy::reorder() {
+        CG_PROFILE_ZONE("TransformHierarchy::reorder");
+
+        const uint32_t count = parents.size();
+
+        // Children lists, counting sort by parent, keeping the current relative order
+        std::vector<uint32_t> childStarts((count + 3), 0), children(count);
+        for (uint32_t i = 0; i < count; ++i) ++childStarts[((parents[i] == noParent)? count:parents[i]) + 2];
+        for (uint32_t i = 2; i < childStarts.size(); ++i) childStarts[i] += childStarts[i - 1];
+        for (uint32_t i = 0; i < count; ++i) children[childStarts[((parents[i] == noParent)? count:parents[i]) + 1]++] = i;
+        // Node n's children are now children[childStarts[n], childStarts[n + 1]), roots are the 'count' entry
+
+        std::vector<uint32_t> order, stack;
+        order.reserve(count);
+        for (uint32_t root = childStarts[count + 1]; root-- > childStarts[count];) stack.push_back(children[root]);
+        while (!stack.empty()) {
+            const uint32_t node = stack.back();
+            stack.pop_back();
+            order.push_back(node);
+            for (uint32_t child = childStarts[node + 1]; child-- > childStarts[node];) stack.push_back(children[child]);
+        }
+
+        std::vector<uint32_t> newIndices(count);
+        for (uint32_t i = 0; i < count; ++i) newIndices[order[i]] = i;
+
+        const auto permute = [&](auto &values) {
+            std::remove_reference_t<decltype(values)> result;
+            result.reserve(count);
+            for (const uint32_t oldIndex: order) result.push_back(values[oldIndex]);
+            values.swap(result);
+        };
+        permute(parents);
+        permute(ids);
+        permute(positions);
+        permute(rotations);
+        permute(scales);
+        permute(worldMatrices);
+        permute(dirty);
+        permute(changed);
+
+        for (uint32_t &parent: parents) {
+            if (parent != noParent) parent = newIndices[parent];
+        }
+        for (uint32_t i = 0; i < count; ++i) indices[ids[i]] = i;
+
+        // Children come after their parent now, so one backward pass finds every subtree's end and dirty state
+        subtreeEnds.assign(count, 0);
+        subtreeDirty.assign(count, false);
+        for (uint32_t i = count; i-- > 0;) {
+            if (subtreeEnds[i] == 0) subtreeEnds[i] = (i + 1);
+            subtreeDirty[i] = (subtreeDirty[i] || dirty[i]);
+
+            if (parents[i] != noParent) {
+                subtreeEnds[parents[i]] = std::max(subtreeEnds[parents[i]], subtreeEnds[i]);
+                subtreeDirty[parents[i]] = (subtreeDirty[parents[i]] || subtreeDirty[i]);
+            }
+        }
+
+        orderChanged = false;
+    }
+
+    bool TransformHierarchy::updateNode(uint32_t index) noexcept {
+        const uint32_t parent = parents[index];
+        const bool nodeChanged = (dirty[index] || ((parent != noParent) && changed[parent]));
+        changed[index] = nodeChanged;
+        dirty[index] = false;
+        subtreeDirty[index] = false;
+
+        if (nodeChanged) {
+            const Matrix4 local = model<float32_t>(positions[index], rotations[index], scales[index]);
+            if (parent == noParent) worldMatrices[index] = local;
+            else multiplyWorld(worldMatrices[parent], local, worldMatrices[index]);
+        }
+        return nodeChanged;
+    }
+
+    size_t TransformHierarchy::updateRange(uint32_t begin, uint32_t end) noexcept {
+        size_t result = 0;
+        for (uint32_t i = begin; i < end;) {
+            // Nothing below changed and neither did the parent's world matrix
+            const uint32_t parent = parents[i];
+            if (!subtreeDirty[i] && ((parent == noParent) || !changed[parent])) {
+                changed[i] = false;
+                i = subtreeEnds[i];
+                continue;
+            }
+
+            result += updateNode(i);
+            ++i;
+        }
+        return result;
+    }
+
+    void TransformHierarchy::collectTasks(uint32_t index, size_t grainSize, std::vector<uint32_t> &heads, std::vector<std::pair<uint32_t, uint32_t>> &tasks) const {
+        const uint32_t end = subtreeEnds[index];
+        if (((end - index) <= grainSize) || ((index + 1) == end)) {
+            tasks.emplace_back(index, end);
+            return;
+        }
+
+        // Too big for one task: the node itself is updated first, then each child subtree becomes independent
+        heads.push_back(index);
+        for (uint32_t child = (index + 1); child < end; child = subtreeEnds[child]) collectTasks(child, grainSize, heads, tasks);
+    }
+
+    TransformId TransformHierarchy::create(TransformId parent, const Vector3 &position, const Quaternion<float32_t> &rotation, const Vector3 &scale) {
+        const uint32_t parentIndex = (parent.isValid()? getIndex(parent):noParent);
+        const uint32_t index = parents.size();
+
+        TransformId id;
+        if (freeIds.empty()) {
+            id.index = indices.size();
+            indices.push_back(index);
+        }
+        else {
+            id.index = freeIds.back();
+            freeIds.pop_back();
+            indices[id.index] = index;
+        }
+
+        parents.push_back(parentIndex);
+        subtreeEnds.push_back(index + 1);
+        ids.push_back(id.index);
+        positions.push_back(position);
+        rotations.push_back(rotation);
+        scales.push_back(scale);
+        worldMatrices.push_back(Matrix4::identity);
+        dirty.push_back(false);
+        subtreeDirty.push_back(false);
+        changed.push_back(false);
+
+        // Appending keeps depth first order for roots, and for children of a node whose subtree already ends the arrays, ex.: while building depth first
+        if (parentIndex != noParent) {
+            if (!orderChanged && (subtreeEnds[parentIndex] == index)) {
+                for (uint32_t i = parentIndex; i != noParent; i = parents[i]) subtreeEnds[i] = (index + 1);
+            }
+            else orderChanged = true;
+        }
+
+        markDirty(index);
+        return id;
+    }
+
+    void TransformHierarchy::destroy(TransformId id) {
+        if (orderChanged) reorder();
+
+        const uint32_t begin = getIndex(id), end = subtreeEnds[begin];
+        const uint32_t removedCount = (end - begin);
+
+        // The parent's world matrix didn't change, but clean ancestors stay consistent either way
+        for (uint32_t i = begin; i < end; ++i) {
+            indices[ids[i]] = noParent;
+            freeIds.push_back(ids[i]);
+        }
+
+        const auto erase = [&](auto &values) {values.erase((values.begin() + begin), (values.begin() + end));};
+        erase(parents);
+        erase(subtreeEnds);
+        erase(ids);
+        erase(positions);
+        erase(rotations);
+        erase(scales);
+        erase(worldMatrices);
+        erase(dirty);
+        erase(subtreeDirty);
+        erase(changed);
+
+        for (uint32_t i = 0; i < parents.size(); ++i) {
+            if ((parents[i] != noParent) && (parents[i] >= end)) parents[i] -= removedCount;
+            if (subtreeEnds[i] >= end) subtreeEnds[i] -= removedCount;
+            if (i >= begin) indices[ids[i]] = i;
+        }
+    }
+
+    bool TransformHierarchy::exists(TransformId id) const noexcept {
+        return (id.isValid() && (id.index < indices.size()) && (indices[id.index] != noParent));
+    }
+
+    size_t TransformHierarchy::getCount() const noexcept {return parents.size();}
+
+    TransformId TransformHierarchy::getParent(TransformId id) const {
+        const uint32_t parent = parents[getIndex(id)];
+        return ((parent == noParent)? TransformId():TransformId{ids[parent]});
+    }
+
+    void TransformHierarchy::setParent(TransformId id, TransformId parent) {
+        const uint32_t index = getIndex(id);
+        const uint32_t parentIndex = (parent.isValid()? getIndex(parent):noParent);
+        if (parents[index] == parentIndex) return;
+
+        for (uint32_t i = parentIndex; i != noParent; i = parents[i]) {
+            if (i == index) throw std::invalid_argument("Can't parent a transform to itself or its descendant:\n" + std::to_string(std::stacktrace::current()));
+        }
+
+        parents[index] = parentIndex;
+        orderChanged = true;
+        markDirty(index); // Reordering rebuilds the subtree flags, only the node's own flag matters here
+    }
+
+    const Vector3 &TransformHierarchy::getPosition(TransformId id) const {return positions[getIndex(id)];}
+    const Quaternion<float32_t> &TransformHierarchy::getRotation(TransformId id) const {return rotations[getIndex(id)];}
+    const Vector3 &TransformHierarchy::getScale(TransformId id) const {return scales[getIndex(id)];}
+
+    void TransformHierarchy::setPosition(TransformId id, const Vector3 &position) {
+        const uint32_t index = getIndex(id);
+        positions[index] = position;
+        markDirty(index);
+    }
+
+    void TransformHierarchy::setRotation(TransformId id, const Quaternion<float32_t> &rotation) {
+        const uint32_t index = getIndex(id);
+        rotations[index] = rotation;
+        markDirty(index);
+    }
+
+    void TransformHierarchy::setScale(TransformId id, const Vector3 &scale) {
+        const uint32_t index = getIndex(id);
+        scales[index] = scale;
+        markDirty(index);
+    }
+
+    void TransformHierarchy::setLocal(TransformId id, const Vector3 &position, const Quaternion<float32_t> &rotation, const Vector3 &scale) {
+        const uint32_t index = getIndex(id);
+        positions[index] = position;
+        rotations[index] = rotation;
+        scales[index] = scale;
+        markDirty(index);
+    }
+
+    void TransformHierarchy::update(bool parallel) {
+        CG_PROFILE_ZONE("TransformHierarchy::update");
+
+        if (orderChanged) reorder();
+        const uint32_t count = parents.size();
+
+        if (!parallel || !JobSystem::isRunning()) {
+            updatedCount = updateRange(0, count);
+            return;
+        }
+
+        // A few tasks per thread, so uneven subtrees still balance
+        const size_t grainSize = std::max<size_t>((count / ((JobSystem::getWorkerCount() + 1) * 4)), 1);
+        taskHeads.clear();
+        tasks.clear();
+        for (uint32_t root = 0; root < count; root = subtreeEnds[root]) {
+            if (subtreeDirty[root]) collectTasks(root, grainSize, taskHeads, tasks);
+        }
+
+        // Heads are in hierarchy order and each one's subtree still had to be dirty, so they're updated directly
+        size_t updated = 0;
+        for (const uint32_t head: taskHeads) updated += updateNode(head);
+
+        std::atomic<size_t> updatedByTasks = 0;
+        JobSystem::parallelFor(tasks.size(), [&](size_t begin, size_t end) {
+            size_t result = 0;
+            for (size_t task = begin; task < end; ++task) result += updateRange(tasks[task].first, tasks[task].second);
+            updatedByTasks.fetch_add(result, std::memory_order_relaxed);
+        }); // Tasks are mostly small dirty objects, batched a few jobs per thread
+
+        updatedCount = (updated + updatedByTasks.load(std::memory_order_relaxed));
+    }
+
+    const Matrix4 &TransformHierarchy::getWorldMatrix(TransformId id) const {return worldMatrices[getIndex(id)];}
+    size_t TransformHierarchy::getUpdatedCount() const noexcept {return updatedCount;}
+}
\ No newline at end of file
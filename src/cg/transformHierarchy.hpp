@@ -0,0 +1,71 @@
+#pragma once
+
+#include "_cgControl.hpp"
+
+namespace CG {
+    // Stable across reparenting and other nodes' destruction
+    struct TransformId {
+        static constexpr uint32_t invalidIndex = std::numeric_limits<uint32_t>::max();
+
+        uint32_t index = invalidIndex;
+
+        constexpr bool isValid() const noexcept {return (index != invalidIndex);}
+        constexpr bool operator==(const TransformId &) const noexcept = default;
+    };
+
+
+    // Local transforms and cached world matrices of a whole scene, as flat arrays kept in depth first order, so every subtree is one contiguous range
+    // after its root. Setting a local transform only flags it, 'update' then recomputes the flagged nodes and their descendants, skipping clean subtrees whole.
+    class TransformHierarchy {
+        private:
+            static constexpr uint32_t noParent = std::numeric_limits<uint32_t>::max();
+
+            // Per node, by hierarchy order
+            std::vector<uint32_t> parents;
+            std::vector<uint32_t> subtreeEnds; // One past the node's last descendant
+            std::vector<uint32_t> ids;
+            std::vector<Vector3> positions, scales;
+            std::vector<Quaternion<float32_t>> rotations;
+            std::vector<Matrix4> worldMatrices;
+            std::vector<uint8_t> dirty; // Local transform changed
+            std::vector<uint8_t> subtreeDirty; // The node or a descendant is dirty, always set on every ancestor of a set node too
+            std::vector<uint8_t> changed; // World matrix recomputed by the current update
+
+            std::vector<uint32_t> indices; // By id, 'noParent' once freed
+            std::vector<uint32_t> freeIds;
+            bool orderChanged = false;
+            size_t updatedCount = 0;
+            std::vector<uint32_t> taskHeads; // Of a parallel update, kept so a steady one doesn't allocate
+            std::vector<std::pair<uint32_t, uint32_t>> tasks;
+
+            uint32_t getIndex(TransformId id) const;
+            void markDirty(uint32_t index) noexcept;
+            void reorder();
+            bool updateNode(uint32_t index) noexcept;
+            size_t updateRange(uint32_t begin, uint32_t end) noexcept;
+            void collectTasks(uint32_t index, size_t grainSize, std::vector<uint32_t> &heads, std::vector<std::pair<uint32_t, uint32_t>> &tasks) const;
+
+        public:
+            TransformId create(TransformId parent = {}, const Vector3 &position = Vector3::zero, const Quaternion<float32_t> &rotation = Quaternion<float32_t>::identity, const Vector3 &scale = Vector3::one);
+            void destroy(TransformId id); // And its descendants
+            bool exists(TransformId id) const noexcept;
+            size_t getCount() const noexcept;
+
+            TransformId getParent(TransformId id) const;
+            void setParent(TransformId id, TransformId parent); // Invalid parent makes it a root. Parenting to a descendant throws.
+
+            const Vector3 &getPosition(TransformId id) const;
+            const Quaternion<float32_t> &getRotation(TransformId id) const;
+            const Vector3 &getScale(TransformId id) const;
+            void setPosition(TransformId id, const Vector3 &position);
+            void setRotation(TransformId id, const Quaternion<float32_t> &rotation);
+            void setScale(TransformId id, const Vector3 &scale);
+            void setLocal(TransformId id, const Vector3 &position, const Quaternion<float32_t> &rotation, const Vector3 &scale);
+
+            // Ancestors' changes reach descendants here. In parallel, independent subtrees are split into 'JobSystem' jobs, the caller running some too.
+            // Inline while the job system isn't running.
+            void update(bool parallel = false);
+            const Matrix4 &getWorldMatrix(TransformId id) const; // As of the last 'update'
+            size_t getUpdatedCount() const noexcept; // World matrices the last 'update' recomputed
+    };
+}
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "init.hpp"
 #include "error.hpp"
 #include "window.hpp"
+#include "frameArena.hpp"
 
 namespace CG {
 
@@ -11,18 +12,45 @@ namespace CG {
         w = nullptr;
         title = "";
         size = WindowSize(0, 0);
-        onRenderLoop = [](){};
+        onRenderLoop = {};
         vaoId = 0;
+        textureUnits.reset();
+        bindlessResidency.reset();
+        gpuTimers.reset();
+        renderThread.reset();
+        swapInterval = 0;
+        appliedSwapInterval = -1;
+        viewportSize = WindowSize(0, 0);
+        appliedViewportSize = WindowSize(0, 0);
+        headless = false;
+        framebufferId = 0;
+        colorRenderbufferId = 0;
+        depthStencilRenderbufferId = 0;
     }
 
     void Window::moveFrom(Window &other) {
         if (this == &other) return;
 
+        const bool threaded = other.hasRenderThread(); // The thread works on 'other', restart it on this
+        stopRenderThread();
+        other.stopRenderThread();
+
         this->w = other.w;
         this->title = other.title;
         this->size = other.size;
         this->onRenderLoop = other.onRenderLoop;
         this->vaoId = other.vaoId;
+        this->textureUnits = std::move(other.textureUnits);
+        this->bindlessResidency = std::move(other.bindlessResidency);
+        this->gpuTimers = std::move(other.gpuTimers);
+        this->swapInterval = other.swapInterval;
+        this->appliedSwapInterval = other.appliedSwapInterval;
+        this->viewportSize = other.viewportSize;
+        this->appliedViewportSize = other.appliedViewportSize;
+        this->headless = other.headless;
+        this->framebufferId = other.framebufferId;
+        this->colorRenderbufferId = other.colorRenderbufferId;
+        this->depthStencilRenderbufferId = other.depthStencilRenderbufferId;
 
         // Add this to instances
         const auto thisIter = std::find(instances.begin(), instances.end(), this);
@@ -32,7 +60,40 @@ namespace CG {
         const auto otherIter = std::find(instances.begin(), instances.end(), &other);
         if (otherIter != instances.end()) instances.erase(otherIter);
 
+        if (this->w != nullptr) glfwSetWindowUserPointer(this->w, this); // 'find' goes through it
+
         other.clearFields();
+
+        if (threaded) startRenderThread();
+    }
+
+    void Window::runRenderThread() {
+        glfwMakeContextCurrent(w);
+
+        while (true) {
+            {
+                std::unique_lock lock(renderThread->mutex);
+                renderThread->signal.wait(lock, [this]() {return (renderThread->stopping || (renderThread->requestedFrame > renderThread->completedFrame));});
+                if (renderThread->stopping) break;
+            }
+
+            std::exception_ptr error = nullptr;
+            try {
+                render();
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+
+            {
+                const std::lock_guard lock(renderThread->mutex);
+                renderThread->error = error;
+                ++renderThread->completedFrame;
+            }
+            renderThread->signal.notify_all();
+        }
+
+        glfwMakeContextCurrent(nullptr);
     }
 
     const std::vector<Window *> &Window::getInstances() {
@@ -40,20 +101,50 @@ namespace CG {
     }
 
     Window *Window::find(GLFWwindow *ptr) {
-        for (const auto &window: instances) {
-            if (window->w == ptr) return window;
-        }
-        return nullptr;
+        // Null for contexts that aren't windows, like the resource queue's
+        return ((ptr == nullptr)? nullptr:static_cast<Window *>(glfwGetWindowUserPointer(ptr)));
     }
 
     Window *Window::getCurrentContext() {
         return find(glfwGetCurrentContext());
     }
 
-    Window::Window(std::string_view title, int width, int height) {
-        if (!isGlfwInitialized()) initializeGlfw();
+    void Window::createFramebuffer(int width, int height) {
+        glCreateRenderbuffers(1, &colorRenderbufferId);
+        glNamedRenderbufferStorage(colorRenderbufferId, GL_RGBA8, width, height);
+        glCreateRenderbuffers(1, &depthStencilRenderbufferId);
+        glNamedRenderbufferStorage(depthStencilRenderbufferId, GL_DEPTH24_STENCIL8, width, height);
 
+        glCreateFramebuffers(1, &framebufferId);
+        glNamedFramebufferRenderbuffer(framebufferId, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRenderbufferId);
+        glNamedFramebufferRenderbuffer(framebufferId, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthStencilRenderbufferId);
+
+        if (glCheckNamedFramebufferStatus(framebufferId, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            throw std::runtime_error("Headless framebuffer for \"" + title + "\" is incomplete:\n" + std::to_string(std::stacktrace::current()));
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, framebufferId);
+    }
+
+    void Window::deleteFramebuffer() {
+        // Framebuffer objects aren't shared, so this context has to be current
+        glDeleteFramebuffers(1, &framebufferId);
+        glDeleteRenderbuffers(1, &colorRenderbufferId);
+        glDeleteRenderbuffers(1, &depthStencilRenderbufferId);
+        framebufferId = 0;
+        colorRenderbufferId = 0;
+        depthStencilRenderbufferId = 0;
+    }
+
+    Window::Window(std::string_view title, int width, int height, const WindowOptions &options) {
+        if (!isGlfwInitialized()) initializeGlfw(options.headless && (options.contextApi != ContextApi::Native));
+
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, static_cast<int>(options.contextApi));
+        glfwWindowHint(GLFW_VISIBLE, (options.headless? GLFW_FALSE:GLFW_TRUE));
         this->w = glfwCreateWindow(width, height, title.data(), nullptr, (instances.empty()? nullptr:instances[0]->w)); // Always share context with first possible window
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_NATIVE_CONTEXT_API);
+        glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+
         this->title = title;
         this->size = WindowSize(width, height);
 
@@ -69,17 +160,25 @@ namespace CG {
         glGenVertexArrays(1, &this->vaoId);
         glBindVertexArray(this->vaoId);
 
+        this->textureUnits = std::make_unique<TextureUnitAllocator>();
+        if (BindlessApi::get().has_value()) this->bindlessResidency = std::make_unique<BindlessResidency>(BindlessApi::get().value());
+        this->gpuTimers = std::make_unique<GpuTimerPool>("GPU " + std::string(title));
+
         glEnable(GL_DEBUG_OUTPUT);
         glDebugMessageCallback(onGlError, nullptr);
 
+        this->headless = options.headless;
+        if (this->headless) this->createFramebuffer(width, height);
+
         glViewport(0, 0, width, height);
+        this->viewportSize = WindowSize(width, height);
+        this->appliedViewportSize = this->viewportSize;
         glfwSetFramebufferSizeCallback(this->w, [](GLFWwindow *w, int width, int height) -> void {
-            const auto previousContext = glfwGetCurrentContext();
-            glfwMakeContextCurrent(w);
-            glViewport(0, 0, width, height);
-            glfwMakeContextCurrent(previousContext);
+            // The context may be current on a render thread, so the viewport is applied by the next 'render'
+            if (Window *const window = Window::find(w)) window->viewportSize = WindowSize(width, height);
         });
 
+        glfwSetWindowUserPointer(this->w, this);
         instances.push_back(this);
     }
 
@@ -91,15 +190,104 @@ namespace CG {
         glfwMakeContextCurrent(this->w);
     }
 
-    void Window::renderLoop() const {
+    void Window::render() const {
+        CG_PROFILE_ZONE("Window::render");
+
         makeContextCurrent();
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-        onRenderLoop();
-        glfwSwapBuffers(w);
+        if (appliedViewportSize != viewportSize) {
+            glViewport(0, 0, viewportSize.x, viewportSize.y);
+            appliedViewportSize = viewportSize;
+        }
+        if (appliedSwapInterval != swapInterval) {
+            glfwSwapInterval(swapInterval);
+            appliedSwapInterval = swapInterval;
+        }
+        if (bindlessResidency) bindlessResidency->beginFrame();
+        if (Profiler::isEnabled()) gpuTimers->beginFrame();
+
+        {
+            CG_PROFILE_GPU_ZONE("Frame");
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+            if (onRenderLoop) onRenderLoop();
+        }
+        FrameArena::getThread().reset(); // Transient frame data is done with
+
+        CG_PROFILE_ZONE("Swap");
+        if (!headless) glfwSwapBuffers(w); // Headless frames stay in the framebuffer object, which is bound for good
+    }
+
+    void Window::renderLoop() const {
+        if (hasRenderThread()) {
+            requestRender();
+            waitForRender();
+        }
+        else render();
+
         glfwPollEvents();
     }
 
+    void Window::startRenderThread() {
+        if (hasRenderThread() || !exists()) return;
+
+        // A context can only be current on one thread
+        if (glfwGetCurrentContext() == w) glfwMakeContextCurrent(nullptr);
+
+        renderThread = std::make_unique<RenderThread>();
+        renderThread->thread = std::thread(&Window::runRenderThread, this);
+    }
+
+    void Window::stopRenderThread() {
+        if (!hasRenderThread()) return;
+
+        {
+            const std::lock_guard lock(renderThread->mutex);
+            renderThread->stopping = true;
+        }
+        renderThread->signal.notify_all();
+        renderThread->thread.join();
+        renderThread.reset();
+    }
+
+    bool Window::hasRenderThread() const noexcept {
+        return (renderThread != nullptr);
+    }
+
+    void Window::requestRender() const {
+        ASSERT(hasRenderThread());
+
+        {
+            const std::lock_guard lock(renderThread->mutex);
+            ++renderThread->requestedFrame;
+        }
+        renderThread->signal.notify_all();
+    }
+
+    void Window::waitForRender() const {
+        ASSERT(hasRenderThread());
+
+        std::unique_lock lock(renderThread->mutex);
+        renderThread->signal.wait(lock, [this]() {return (renderThread->completedFrame >= renderThread->requestedFrame);});
+
+        if (renderThread->error) std::rethrow_exception(std::exchange(renderThread->error, nullptr));
+    }
+
+    int32_t Window::getSwapInterval() const noexcept {
+        return swapInterval;
+    }
+
+    void Window::setSwapInterval(int32_t value) {
+        swapInterval = value;
+    }
+
     void Window::close() {
+        stopRenderThread();
+        if (this->exists() && ((framebufferId != 0) || (gpuTimers != nullptr))) {
+            const auto previousContext = glfwGetCurrentContext();
+            makeContextCurrent();
+            if (framebufferId != 0) deleteFramebuffer();
+            gpuTimers.reset(); // Its queries belong to this context too
+            glfwMakeContextCurrent((previousContext == w)? nullptr:previousContext);
+        }
         if (this->exists()) glfwDestroyWindow(w);
         clearFields();
         auto windowIt = std::find(instances.begin(), instances.end(), this);
@@ -114,6 +302,41 @@ namespace CG {
         return (w != nullptr);
     }
 
+    bool Window::isHeadless() const noexcept {
+        return headless;
+    }
+
+    std::vector<uint8_t> Window::readPixels() const {
+        ASSERT(!hasRenderThread() || (glfwGetCurrentContext() == w)); // From the render thread, or with it stopped
+
+        const auto previousContext = glfwGetCurrentContext();
+        makeContextCurrent();
+
+        const size_t width = static_cast<size_t>(viewportSize.x), height = static_cast<size_t>(viewportSize.y);
+        std::vector<uint8_t> pixels(width * height * 4);
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, framebufferId);
+        glReadBuffer(headless? GL_COLOR_ATTACHMENT0:GL_BACK);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, viewportSize.x, viewportSize.y, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+        glfwMakeContextCurrent(previousContext);
+
+        // GL rows start at the bottom
+        std::vector<uint8_t> flipped(pixels.size());
+        for (size_t row = 0; row < height; ++row) {
+            std::copy_n(&pixels[(height - 1 - row) * width * 4], (width * 4), &flipped[row * width * 4]);
+        }
+        return flipped;
+    }
+
+    void Window::savePng(const std::filesystem::path &path) const {
+        const std::vector<uint8_t> pixels = readPixels();
+        if (stbi_write_png(path.string().c_str(), viewportSize.x, viewportSize.y, 4, pixels.data(), (viewportSize.x * 4)) == 0) {
+            throw std::runtime_error("Failed to write \"" + path.string() + "\":\n" + std::to_string(std::stacktrace::current()));
+        }
+    }
+
     GLFWwindow *Window::getWPtr() const {
         return w;
     }
@@ -160,11 +383,23 @@ namespace CG {
         return (size.x / size.y);
     }
 
-    std::function<void()> Window::getOnRenderLoop() const {
+    TextureUnitAllocator &Window::getTextureUnits() const {
+        return *textureUnits;
+    }
+
+    BindlessResidency *Window::getBindlessResidency() const {
+        return bindlessResidency.get();
+    }
+
+    GpuTimerPool *Window::getGpuTimers() const {
+        return gpuTimers.get();
+    }
+
+    FunctionRef<void()> Window::getOnRenderLoop() const {
         return onRenderLoop;
     }
 
-    void Window::setOnRenderLoop(const std::function<void()> &newOnRenderLoop) {
+    void Window::setOnRenderLoop(FunctionRef<void()> newOnRenderLoop) {
         onRenderLoop = newOnRenderLoop;
     }
 
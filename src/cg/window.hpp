@@ -2,25 +2,67 @@
 
 #include <vector>
 #include <string>
+#include <memory>
 #include <functional>
 #include <string_view>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
 #include "_cgControl.hpp"
+#include "textureUnits.hpp"
+#include "bindless.hpp"
+#include "profiler.hpp"
+#include "functionRef.hpp"
 
 namespace CG {
     using WindowSize = Vector<int, 2>;
 
+    enum class ContextApi {
+        Native = GLFW_NATIVE_CONTEXT_API,
+        Egl    = GLFW_EGL_CONTEXT_API   , // Surfaceless with the null platform
+        OSMesa = GLFW_OSMESA_CONTEXT_API  // Software (llvmpipe), needs no GPU
+    };
+
+    struct WindowOptions {
+        bool headless = false;                      // Hidden, and renders into a framebuffer object of the window's size instead of the default framebuffer
+        ContextApi contextApi = ContextApi::Native; // Headless EGL or OSMesa windows run GLFW on its null platform, which must then be the first thing initializing it
+    };
+
     class Window {
         private:
+            // Renders on its own thread with the window's context current there, one frame per 'requestRender'
+            struct RenderThread {
+                std::thread thread;
+                std::mutex mutex;
+                std::condition_variable signal;
+                uint64_t requestedFrame = 0, completedFrame = 0;
+                bool stopping = false;
+                std::exception_ptr error = nullptr;
+            };
+
             static std::vector<Window *> instances;
 
             GLFWwindow *w = nullptr;
             std::string title = "";
             WindowSize size = WindowSize(0, 0);
-            std::function<void()> onRenderLoop = [](){};
+            FunctionRef<void()> onRenderLoop; // Empty renders nothing but the clear
             uint32_t vaoId = 0;
+            std::unique_ptr<TextureUnitAllocator> textureUnits = nullptr;
+            std::unique_ptr<BindlessResidency> bindlessResidency = nullptr; // Null without GL_ARB_bindless_texture
+            std::unique_ptr<GpuTimerPool> gpuTimers = nullptr;
+            std::unique_ptr<RenderThread> renderThread = nullptr;
+            bool headless = false;
+            uint32_t framebufferId = 0, colorRenderbufferId = 0, depthStencilRenderbufferId = 0; // Headless only
+            int32_t swapInterval = 0;
+            mutable int32_t appliedSwapInterval = -1; // Only touched by the thread the context is current on
+            WindowSize viewportSize = WindowSize(0, 0);  // Framebuffer size, set while polling events
+            mutable WindowSize appliedViewportSize = WindowSize(0, 0);
 
             void clearFields();
             void moveFrom(Window &);
+            void runRenderThread();
+            void createFramebuffer(int width, int height);
+            void deleteFramebuffer();
 
         public:
             static const std::vector<Window *> &getInstances();
@@ -28,15 +70,31 @@ namespace CG {
             static Window *getCurrentContext();
 
             Window() = default;
-            Window(std::string_view title, int width, int height);
+            Window(std::string_view title, int width, int height, const WindowOptions &options = {});
             Window(const Window &) = delete;
             Window(Window &&other);
 
             void makeContextCurrent() const;
-            void renderLoop() const;
+            void render() const;     // Clear, 'onRenderLoop', swap
+            void renderLoop() const; // 'render' then poll events, for a loop driving a single window
+
+            // With a render thread, 'render' must not be called directly: 'requestRender' starts a frame and 'waitForRender' joins it.
+            // Program uniforms are shared between contexts, so windows rendering in parallel shouldn't set uniforms on the same 'Shader'.
+            void startRenderThread(); // On the main thread
+            void stopRenderThread();  // Makes no context current on the render thread before it exits
+            bool hasRenderThread() const noexcept;
+            void requestRender() const;
+            void waitForRender() const; // Rethrows what the frame threw
+
+            int32_t getSwapInterval() const noexcept;
+            void setSwapInterval(int32_t value); // Applied by the next 'render', on whichever thread the context is current
             void close();
             bool shouldClose() const;
             bool exists() const;
+            bool isHeadless() const noexcept;
+
+            std::vector<uint8_t> readPixels() const;               // RGBA, top row first. Of the framebuffer object if headless, else of the back buffer (call from 'onRenderLoop').
+            void savePng(const std::filesystem::path &path) const; // 'readPixels' written out, for image based regression tests
 
             GLFWwindow *getWPtr() const;
 
@@ -55,8 +113,12 @@ namespace CG {
 
             int getAspectRatio() const;
 
-            std::function<void()> getOnRenderLoop() const;
-            void setOnRenderLoop(const std::function<void()> &);
+            TextureUnitAllocator &getTextureUnits() const;
+            BindlessResidency *getBindlessResidency() const;
+            GpuTimerPool *getGpuTimers() const;
+
+            FunctionRef<void()> getOnRenderLoop() const;
+            void setOnRenderLoop(FunctionRef<void()>); // Not copied, the callable has to outlive the window or the next call
 
             Window &operator=(const Window &) = delete;
             Window &operator=(Window &&other);
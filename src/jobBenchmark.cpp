@@ -0,0 +1,72 @@
+#include "cg/jobSystem.hpp"
+#include "cg/frameArena.hpp"
+
+// Scaling of 'JobSystem::parallelFor' with the worker count, no window or GL involved.
+// Usage: jobBenchmark [--workers=N] [--count=N] [--iterations=N] [--grain=N]
+// Runs the same loop inline, then with 1 to N workers (one per core by default), and prints the time per 'parallelFor' and the speedup over inline.
+// Built with COUNT_ALLOCATIONS=1, it also prints the heap allocations per 'parallelFor' past the warm up, 0 once the job pool grew.
+
+struct BenchmarkSettings {
+    size_t workers = CG::JobSystem::getDefaultWorkerCount();
+    size_t count = 1'000'000; // Elements per 'parallelFor'
+    size_t iterations = 200;
+    size_t grain = CG::JobSystem::automaticGrainSize;
+};
+
+BenchmarkSettings parseArguments(int argc, char **argv) {
+    BenchmarkSettings result;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view argument = argv[i];
+        const size_t separator = argument.find('=');
+        const std::string_view name = argument.substr(0, separator);
+        const std::string value((separator == std::string_view::npos)? std::string_view():argument.substr(separator + 1));
+
+        if (name == "--workers") result.workers = std::stoull(value);
+        else if (name == "--count") result.count = std::stoull(value);
+        else if (name == "--iterations") result.iterations = std::stoull(value);
+        else if (name == "--grain") result.grain = std::stoull(value);
+        else throw std::invalid_argument("Unknown argument \"" + std::string(argument) + '"');
+    }
+
+    return result;
+}
+
+int main(int argc, char **argv) {
+    using namespace CG;
+
+    const BenchmarkSettings settings = parseArguments(argc, argv);
+    constexpr size_t warmUpIterations = 10;
+
+    // Some arithmetic per element, so the chunks aren't only memory bound
+    std::vector<float32_t> values(settings.count);
+    const auto work = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            float32_t value = static_cast<float32_t>(i);
+            for (size_t step = 0; step < 16; ++step) value = std::sqrt((value * 1.0001f) + 1.0f);
+            values[i] = value;
+        }
+    };
+
+    float64_t inlineMilliseconds = 0.0;
+    for (size_t workers = 0; workers <= settings.workers; ++workers) {
+        if (workers > 0) JobSystem::start(workers);
+
+        for (size_t i = 0; i < warmUpIterations; ++i) JobSystem::parallelFor(settings.count, work, settings.grain);
+
+        const size_t allocations = AllocationCounter::getCount(), stolen = JobSystem::getStolenCount();
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < settings.iterations; ++i) JobSystem::parallelFor(settings.count, work, settings.grain);
+        const float64_t milliseconds = (std::chrono::duration<float64_t, std::milli>(std::chrono::steady_clock::now() - start).count() / settings.iterations);
+
+        if (workers == 0) inlineMilliseconds = milliseconds;
+        std::cout << workers << " workers: " << milliseconds << " ms/parallelFor, " << (inlineMilliseconds / milliseconds) << "x inline, "
+            << (static_cast<float64_t>(JobSystem::getStolenCount() - stolen) / settings.iterations) << " steals/parallelFor";
+        if (AllocationCounter::isEnabled()) std::cout << ", " << (static_cast<float64_t>(AllocationCounter::getCount() - allocations) / settings.iterations) << " allocations/parallelFor";
+        std::cout << '\n';
+
+        if (workers > 0) JobSystem::stop();
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -3,8 +3,12 @@
 #define YAML_CPP_STATIC_DEFINE
 
 // Standard C++
+#include <list>
+#include <queue>
 #include <vector>
 #include <string>
+#include <chrono>
+#include <thread>
 #include <fstream>
 #include <optional>
 #include <iostream>
@@ -19,4 +23,5 @@
 #include <yaml-cpp/yaml.h>
 
 // Other libs:
-#include "stb/stb_image.h"
\ No newline at end of file
+#include "stb/stb_image.h"
+#include "stb/stb_image_write.h"
\ No newline at end of file
@@ -1,3 +1,7 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb/stb_image.h"
-#undef STB_IMAGE_IMPLEMENTATION
\ No newline at end of file
+#undef STB_IMAGE_IMPLEMENTATION
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb/stb_image_write.h"
+#undef STB_IMAGE_WRITE_IMPLEMENTATION
\ No newline at end of file
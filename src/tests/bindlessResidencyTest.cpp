@@ -0,0 +1,97 @@
+#include <set>
+#include "../cg/bindless.hpp"
+#include "check.hpp"
+
+// Budget and LRU eviction of 'BindlessResidency' against a stub entry point table, no GL context needed
+
+namespace {
+    std::set<GLuint64> residentHandles;
+    size_t invalidCallCount = 0; // Calls GL would reject with GL_INVALID_OPERATION
+
+    GLuint64 APIENTRY getTextureSamplerHandle(GLuint texture, GLuint sampler) {
+        return ((static_cast<GLuint64>(texture) << 32) | sampler);
+    }
+
+    void APIENTRY makeTextureHandleResident(GLuint64 handle) {
+        if (!residentHandles.insert(handle).second) ++invalidCallCount;
+    }
+
+    void APIENTRY makeTextureHandleNonResident(GLuint64 handle) {
+        if (residentHandles.erase(handle) == 0) ++invalidCallCount;
+    }
+}
+
+int main() {
+    using namespace CG;
+
+    BindlessApi api;
+    api.getTextureSamplerHandle = getTextureSamplerHandle;
+    api.makeTextureHandleResident = makeTextureHandleResident;
+    api.makeTextureHandleNonResident = makeTextureHandleNonResident;
+
+    constexpr uint32_t sampler = 1;
+    constexpr size_t textureSize = 100;
+    BindlessResidency residency(api, (3 * textureSize));
+
+    // Fills the budget
+    for (uint32_t texture = 1; texture <= 3; ++texture) CHECK(residency.acquire(texture, sampler, textureSize) == getTextureSamplerHandle(texture, sampler));
+    CHECK(residency.getResidentCount() == 3);
+    CHECK(residency.getResidentBytes() == (3 * textureSize));
+    CHECK(residency.getEvictionCount() == 0);
+
+    // The least recently used one makes room
+    residency.beginFrame();
+    residency.acquire(4, sampler, textureSize);
+    CHECK(!residency.isResident(1, sampler));
+    CHECK(residency.isResident(4, sampler));
+    CHECK(residency.getEvictionCount() == 1);
+
+    // Using one again moves it to the front, so the next one out is 3, not 2
+    residency.acquire(2, sampler, textureSize);
+    residency.beginFrame();
+    residency.acquire(5, sampler, textureSize);
+    CHECK(!residency.isResident(3, sampler));
+    CHECK(residency.isResident(2, sampler));
+    CHECK(residency.getResidentBytes() == (3 * textureSize));
+
+    // Handles used this frame are never evicted, the budget is exceeded until the next frame instead
+    residency.acquire(6, sampler, textureSize);
+    residency.acquire(7, sampler, textureSize);
+    residency.acquire(8, sampler, textureSize);
+    CHECK(residency.getResidentBytes() == (4 * textureSize));
+    residency.beginFrame();
+    CHECK(residency.getResidentBytes() == (3 * textureSize));
+    CHECK(!residency.isResident(5, sampler));
+
+    // A lower budget evicts right away
+    residency.setBudget(textureSize);
+    CHECK(residency.getResidentCount() == 1);
+    CHECK(residency.isResident(8, sampler));
+
+    // Same texture, other sampler: separate handles, both released together
+    residency.setBudget(10 * textureSize);
+    residency.acquire(8, (sampler + 1), textureSize);
+    CHECK(residency.getResidentCount() == 2);
+    residency.release(8);
+    CHECK(residency.getResidentCount() == 0);
+    CHECK(residency.getResidentBytes() == 0);
+
+    // Queued from another thread, released with the next frame on this one
+    residency.acquire(9, sampler, textureSize);
+    std::thread([&]() {residency.queueRelease(9);}).join();
+    CHECK(residency.isResident(9, sampler));
+    residency.beginFrame();
+    CHECK(!residency.isResident(9, sampler));
+
+    // Or by the next acquire, before a recycled id could be mistaken for the deleted texture
+    residency.acquire(10, sampler, textureSize);
+    residency.queueRelease(10);
+    residency.acquire(10, sampler, (2 * textureSize));
+    CHECK(residency.getResidentBytes() == (2 * textureSize));
+
+    CHECK(residentHandles.size() == residency.getResidentCount());
+    CHECK(invalidCallCount == 0);
+
+    if (checkFailureCount == 0) std::cout << "bindlessResidencyTest passed\n";
+    return CHECK_RESULT();
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <iostream>
+#include <format>
+
+// Checks for the GPU free tests. Unlike 'ASSERT' they stay on in release builds and don't stop at the first failure.
+// A test's main ends with 'return CHECK_RESULT();', non zero when any check failed, so 'make test' stops there.
+
+inline size_t checkFailureCount = 0;
+
+#define CHECK(expression) \
+    if (!(static_cast<bool>(expression))) {\
+        ++checkFailureCount;\
+        std::cerr << std::format("Check \"{}\" failed on file \"{}\" in line {}.\n", #expression, __FILE__, __LINE__);\
+    }
+
+#define CHECK_RESULT() ((checkFailureCount == 0)? 0:1)
\ No newline at end of file
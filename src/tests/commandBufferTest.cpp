@@ -0,0 +1,167 @@
+#include <vector>
+#include "../cg/commandBuffer.hpp"
+#include "check.hpp"
+
+// Recording, merging and visiting of 'CommandBuffer', no GL context needed: nothing here replays, and recording only keeps addresses
+
+namespace {
+    // Storage standing in for GL objects, never dereferenced while recording
+    alignas(std::max_align_t) std::byte shaderStorage[2][sizeof(CG::Shader)];
+    alignas(std::max_align_t) std::byte meshStorage[2][sizeof(CG::Mesh)];
+    alignas(std::max_align_t) std::byte textureStorage[sizeof(CG::Texture)];
+
+    std::vector<CG::RenderCommandType> recordedTypes(const CG::CommandBuffer &buffer) {
+        std::vector<CG::RenderCommandType> result;
+        buffer.visit([&]<typename T>(const T &, auto ...) {result.push_back(T::type);});
+        return result;
+    }
+
+    constexpr size_t recordSize(size_t commandSize, size_t payloadSize = 0) {
+        const size_t unpaddedSize = (sizeof(CG::RenderCommandHeader) + commandSize + payloadSize);
+        return (((unpaddedSize + CG::CommandBuffer::alignment - 1) / CG::CommandBuffer::alignment) * CG::CommandBuffer::alignment);
+    }
+}
+
+int main() {
+    using namespace CG;
+    using Type = RenderCommandType;
+
+    Shader &shaderA = *reinterpret_cast<Shader *>(shaderStorage[0]), &shaderB = *reinterpret_cast<Shader *>(shaderStorage[1]);
+    const Mesh &meshA = *reinterpret_cast<const Mesh *>(meshStorage[0]), &meshB = *reinterpret_cast<const Mesh *>(meshStorage[1]);
+    const Texture &texture = *reinterpret_cast<const Texture *>(textureStorage);
+
+    // Repeated binds are dropped, a different one in between records again
+    CommandBuffer buffer;
+    buffer.bindShader(shaderA);
+    buffer.bindShader(shaderA);
+    buffer.bindMesh(meshA);
+    buffer.bindMesh(meshA);
+    buffer.drawElements(6, 0, GL_UNSIGNED_INT);
+    buffer.bindShader(shaderB);
+    buffer.bindShader(shaderA);
+    buffer.bindMesh(meshB);
+    buffer.bindMesh(meshB);
+    CHECK(buffer.getCommandCount() == 6);
+    CHECK((recordedTypes(buffer) == std::vector<Type>{Type::BindShader, Type::BindMesh, Type::DrawElements, Type::BindShader, Type::BindShader, Type::BindMesh}));
+
+    // Cleared buffers forget what was bound, the next frame starts from nothing
+    buffer.clear();
+    CHECK(buffer.isEmpty());
+    CHECK(buffer.getByteSize() == 0);
+    buffer.bindShader(shaderA);
+    CHECK(buffer.getCommandCount() == 1);
+
+    // Invalid handles record nothing, as the shader's own setters ignore them
+    buffer.setUniform<float32_t>(shaderA, {}, 1.0f);
+    buffer.bindTexture(shaderA, {}, texture);
+    CHECK(buffer.getCommandCount() == 1);
+
+    // Appending keeps each buffer's order and adds up the counts
+    CommandBuffer first, second;
+    first.bindShader(shaderA);
+    first.bindMesh(meshA);
+    first.drawElements(6, 0, GL_UNSIGNED_INT);
+    second.bindShader(shaderB);
+    second.bindTexture(shaderB, {0}, texture);
+    second.drawElementsInstanced(36, 12, GL_UNSIGNED_SHORT, 100);
+
+    const size_t firstByteSize = first.getByteSize();
+    first.append(second);
+    CHECK(first.getCommandCount() == 6);
+    CHECK(first.getByteSize() == (firstByteSize + second.getByteSize()));
+    CHECK((recordedTypes(first) == std::vector<Type>{Type::BindShader, Type::BindMesh, Type::DrawElements, Type::BindShader, Type::BindTexture, Type::DrawElementsInstanced}));
+
+    // The merged buffer continues from the appended one's binds, or its own where that one bound nothing
+    first.bindShader(shaderB);
+    first.bindMesh(meshA);
+    CHECK(first.getCommandCount() == 6);
+
+    size_t visitedCount = 0;
+    first.visit([&]<typename T>(const T &command, auto ...) {
+        if constexpr (std::is_same_v<T, RenderCommands::DrawElementsInstanced>) {
+            CHECK(command.count == 36);
+            CHECK(command.firstIndex == 12);
+            CHECK(command.indexType == GL_UNSIGNED_SHORT);
+            CHECK(command.instanceCount == 100);
+        }
+        else if constexpr (std::is_same_v<T, RenderCommands::BindTexture>) {
+            CHECK(command.shader == &shaderB);
+            CHECK(command.texture == &texture);
+        }
+        ++visitedCount;
+    });
+    CHECK(visitedCount == first.getCommandCount());
+
+    // Uniform values come back byte for byte, with the count and upload function of their type
+    const Matrix4 transform = Matrix4::identity;
+    const std::array<Vector3, 3> colors = {Vector3(1.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f), Vector3(0.0f, 0.0f, 1.0f)};
+    const int32_t sampler = 7;
+
+    CommandBuffer uniforms;
+    uniforms.setUniform<Matrix4>(shaderA, {3}, transform);
+    uniforms.setUniform<Vector3>(shaderA, {4}, std::span<const Vector3>(colors));
+    uniforms.setUniform<int32_t>(shaderB, {5}, sampler);
+    CHECK(uniforms.getCommandCount() == 3);
+
+    size_t uniformCount = 0;
+    uniforms.visit([&]<typename T>(const T &command, auto ...value) {
+        if constexpr (std::is_same_v<T, RenderCommands::SetUniform>) {
+            const std::span<const std::byte> bytes = (value, ...);
+            CHECK(bytes.size() == command.size);
+
+            switch (uniformCount++) {
+                case 0:
+                    CHECK((command.shader == &shaderA) && (command.handle.index == 3) && (command.count == 1));
+                    CHECK(command.upload == &uploadUniform<Matrix4>);
+                    CHECK((bytes.size() == sizeof(transform)) && (std::memcmp(bytes.data(), &transform, sizeof(transform)) == 0));
+                    break;
+                case 1:
+                    CHECK((command.shader == &shaderA) && (command.handle.index == 4) && (command.count == 3));
+                    CHECK(command.upload == &uploadUniform<Vector3>);
+                    CHECK((bytes.size() == sizeof(colors)) && (std::memcmp(bytes.data(), colors.data(), sizeof(colors)) == 0));
+                    break;
+                default:
+                    CHECK((command.shader == &shaderB) && (command.handle.index == 5) && (command.count == 1));
+                    CHECK(command.upload == &uploadUniform<int32_t>);
+                    CHECK((bytes.size() == sizeof(sampler)) && (std::memcmp(bytes.data(), &sampler, sizeof(sampler)) == 0));
+                    break;
+            }
+        }
+    });
+    CHECK(uniformCount == 3);
+
+    // Every record is padded to the alignment, whatever its payload, so the next header starts aligned
+    CommandBuffer records;
+    size_t expectedByteSize = 0;
+    const auto checkAligned = [&](size_t recordByteSize) {
+        expectedByteSize += recordByteSize;
+        CHECK(records.getByteSize() == expectedByteSize);
+        CHECK((records.getByteSize() % CommandBuffer::alignment) == 0);
+    };
+
+    records.bindShader(shaderA);
+    checkAligned(recordSize(sizeof(RenderCommands::BindShader)));
+    records.setUniform<float32_t>(shaderA, {0}, 1.0f);
+    checkAligned(recordSize(sizeof(RenderCommands::SetUniform), sizeof(float32_t)));
+    records.setUniform<Vector3>(shaderA, {1}, Vector3(1.0f, 2.0f, 3.0f));
+    checkAligned(recordSize(sizeof(RenderCommands::SetUniform), sizeof(Vector3)));
+    records.setUniform<Matrix4>(shaderA, {2}, transform);
+    checkAligned(recordSize(sizeof(RenderCommands::SetUniform), sizeof(Matrix4)));
+    records.drawElements(3, 0, GL_UNSIGNED_BYTE);
+    checkAligned(recordSize(sizeof(RenderCommands::DrawElements)));
+
+    // A record without payload nor padding ends the buffer exactly, recording and visiting it must stay in bounds
+    static_assert(recordSize(sizeof(RenderCommands::BindShader)) == (sizeof(RenderCommandHeader) + sizeof(RenderCommands::BindShader)));
+    CommandBuffer unpadded;
+    unpadded.bindShader(shaderA);
+    CHECK(unpadded.getByteSize() == (sizeof(RenderCommandHeader) + sizeof(RenderCommands::BindShader)));
+
+    const Shader *visitedShader = nullptr;
+    unpadded.visit([&]<typename T>(const T &command, auto ...) {
+        if constexpr (std::is_same_v<T, RenderCommands::BindShader>) visitedShader = command.shader;
+    });
+    CHECK(visitedShader == &shaderA);
+
+    if (checkFailureCount == 0) std::cout << "commandBufferTest passed\n";
+    return CHECK_RESULT();
+}
\ No newline at end of file
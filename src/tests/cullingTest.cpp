@@ -0,0 +1,72 @@
+#include "../cg/culling.hpp"
+#include "../cg/space.hpp"
+#include "check.hpp"
+
+// Frustum extraction and 'cullOnCpu', the reference 'batchRender --draw=culled --verify-culling' holds the cull shader to. No GL context needed.
+
+int main() {
+    using namespace CG;
+
+    // batchRender's camera: 1000 units back from the origin, looking down -z
+    const Matrix4 viewProjection = (perspectiveDeg<float32_t>(60, 2.0f, 1.0f, 10000.0f) * view<float32_t>(Vector3(0, 0, 1000), rotationFromEulerDeg(Vector3::zero), Vector3::one));
+    const Frustum frustum = Frustum::fromViewProjection(viewProjection);
+
+    for (const Vector4 &plane: frustum.planes) CHECK(std::abs(Vector3(plane.x, plane.y, plane.z).magnitude() - 1.0f) < 1e-5f);
+    CHECK(std::abs(frustum.planes[5].w - 999.0f) < 1e-2f); // Near plane, 1 unit in front of the camera
+    CHECK(std::abs(frustum.planes[4].w - 8999.0f) < 1.0f); // Far plane
+
+    struct Case {
+        Vector3 position;
+        float32_t radius = 1.0f;
+        float32_t scale = 1.0f;
+        bool visible = false;
+    };
+
+    const std::array<Case, 10> cases = {{
+        {Vector3(0, 0, 0), 1, 1, true},
+        {Vector3(0, 0, 2000), 1, 1, false},      // Behind the camera
+        {Vector3(100000, 0, 0), 1, 1, false},
+        {Vector3(0, 0, -20000), 1, 1, false},    // Past the far plane
+        {Vector3(0, 0, 995), 10, 1, true},       // Center before the near plane, the sphere crosses it
+        {Vector3(0, 0, -9500), 1, 1, false},
+        {Vector3(1200, 0, 0), 10, 1, false},     // Just right of the view
+        {Vector3(1200, 0, 0), 10, 100, true},    // Same, scaled up into it
+        {Vector3(0, 700, 0), 1, 1, false},       // Above the view, which is half as tall as wide
+        {Vector3(0, 250, 0), 1, 1, true}
+    }};
+
+    std::vector<CullObject> objects;
+    for (size_t i = 0; i < cases.size(); ++i) {
+        CullObject object;
+        object.instance.model = model<float32_t>(cases[i].position, rotationFromEulerDeg(Vector3::zero), Vector3::fullOf(cases[i].scale));
+        object.instance.color = Color(static_cast<float32_t>(i), 0.0f, 0.0f, 1.0f); // Tells the instances apart
+        object.bounds = Vector4(0.0f, 0.0f, 0.0f, cases[i].radius);
+        object.indexCount = 6;
+        object.firstIndex = static_cast<uint32_t>(i * 6);
+        objects.push_back(object);
+    }
+
+    // Appends after what's already there, numbering instances on from it
+    std::vector<DrawElementsIndirectCommand> commands(2);
+    std::vector<Instance> draws(2);
+    const size_t keptCount = cullOnCpu(frustum, objects, commands, draws);
+    CHECK(keptCount == 4);
+    CHECK((commands.size() == 6) && (draws.size() == 6));
+
+    // Kept in object order
+    size_t kept = 2;
+    for (size_t i = 0; i < cases.size(); ++i) {
+        const bool drawn = ((kept < draws.size()) && (std::memcmp(&draws[kept], &objects[i].instance, sizeof(Instance)) == 0));
+        CHECK(drawn == cases[i].visible);
+        if (!drawn) continue;
+
+        CHECK(commands[kept].count == objects[i].indexCount);
+        CHECK(commands[kept].firstIndex == objects[i].firstIndex);
+        CHECK(commands[kept].instanceCount == 1);
+        CHECK(commands[kept].baseInstance == kept);
+        ++kept;
+    }
+
+    if (checkFailureCount == 0) std::cout << "cullingTest passed\n";
+    return CHECK_RESULT();
+}
\ No newline at end of file
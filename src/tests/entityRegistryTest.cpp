@@ -0,0 +1,174 @@
+#include "../cg/entityRegistry.hpp"
+#include "check.hpp"
+
+// Handles, component pools and iteration of 'EntityRegistry', no GL context needed
+
+namespace {
+    struct Position {
+        float32_t x = 0.0f, y = 0.0f;
+    };
+
+    struct Velocity {
+        float32_t x = 0.0f, y = 0.0f;
+    };
+
+    struct Tag {
+        uint32_t value = 0;
+    };
+
+    // Every dense slot points back at its entity through the sparse array, and the entities still there keep their own components
+    template<typename T>
+    bool isConsistent(CG::EntityRegistry &registry, const std::vector<CG::Entity> &holders, const std::vector<T> &expected) {
+        CG::ComponentPool<T> &pool = registry.getPool<T>();
+        const std::span<const CG::Entity> entities = pool.getEntities();
+        if ((entities.size() != holders.size()) || (pool.getComponents().size() != holders.size())) return false;
+
+        for (size_t i = 0; i < entities.size(); ++i) {
+            if (!pool.has(entities[i]) || (&pool.get(entities[i]) != &pool.getComponents()[i])) return false;
+        }
+        for (size_t i = 0; i < holders.size(); ++i) {
+            if (!pool.has(holders[i]) || (std::memcmp(&pool.get(holders[i]), &expected[i], sizeof(T)) != 0)) return false;
+        }
+        return true;
+    }
+
+    // Destroyed handles stay dead once their index is reused, the new entity gets the next generation
+    void testStaleHandles() {
+        using namespace CG;
+
+        EntityRegistry registry;
+        const Entity first = registry.create(), second = registry.create();
+        registry.add<Tag>(first, 1u);
+        registry.add<Tag>(second, 2u);
+        CHECK(registry.getCount() == 2);
+
+        registry.destroy(first);
+        CHECK(!registry.isAlive(first));
+        CHECK(!registry.has<Tag>(first));
+        CHECK(registry.tryGet<Tag>(first) == nullptr);
+        CHECK(registry.getCount() == 1);
+
+        const Entity reused = registry.create();
+        CHECK(reused.index == first.index);
+        CHECK(reused.generation == (first.generation + 1));
+        CHECK(registry.isAlive(reused) && !registry.isAlive(first));
+
+        // The stale handle neither sees nor touches what the new entity gets
+        registry.add<Tag>(reused, 3u);
+        CHECK(!registry.has<Tag>(first));
+        registry.remove<Tag>(first);
+        registry.destroy(first);
+        CHECK(registry.isAlive(reused) && (registry.get<Tag>(reused).value == 3));
+        CHECK(registry.get<Tag>(second).value == 2);
+        CHECK(registry.getCount() == 2);
+
+        CHECK(!registry.isAlive(Entity()));
+        CHECK(!registry.isAlive(Entity{.index = 100}));
+    }
+
+    // Removal swaps the last component in, wherever the removed one sits
+    void testSwapRemove() {
+        using namespace CG;
+
+        EntityRegistry registry;
+        std::vector<Entity> holders;
+        std::vector<Position> expected;
+        for (uint32_t i = 0; i < 8; ++i) {
+            holders.push_back(registry.create());
+            expected.push_back(Position(static_cast<float32_t>(i), static_cast<float32_t>(i * 2)));
+            registry.add<Position>(holders.back(), expected.back());
+        }
+        CHECK(isConsistent(registry, holders, expected));
+
+        // Middle, first, last, then the rest, checking after each one
+        for (const size_t removed: {3, 0, 5, 2, 0, 1, 1, 0}) {
+            registry.remove<Position>(holders[removed]);
+            CHECK(!registry.has<Position>(holders[removed]));
+            CHECK(registry.isAlive(holders[removed]));
+
+            holders.erase(holders.begin() + removed);
+            expected.erase(expected.begin() + removed);
+            CHECK(isConsistent(registry, holders, expected));
+        }
+        CHECK(registry.getPool<Position>().getCount() == 0);
+
+        // Adding again to an entity that has the component replaces it in place, built the same way as a new one
+        const Entity entity = registry.create();
+        registry.add<Position>(entity, 1.0f, 2.0f);
+        registry.add<Position>(entity, 3.0f, 4.0f);
+        CHECK(registry.getPool<Position>().getCount() == 1);
+        CHECK((registry.get<Position>(entity).x == 3.0f) && (registry.get<Position>(entity).y == 4.0f));
+    }
+
+    // Every entity with all the components is visited exactly once, whichever pool is the smallest
+    void testIteration() {
+        using namespace CG;
+
+        constexpr uint32_t entityCount = 10'000;
+
+        EntityRegistry registry;
+        std::vector<Entity> entities;
+        for (uint32_t i = 0; i < entityCount; ++i) {
+            const Entity entity = registry.create();
+            entities.push_back(entity);
+            registry.add<Tag>(entity, i);
+            if ((i % 3) == 0) registry.add<Position>(entity);
+            if ((i % 5) == 0) registry.add<Velocity>(entity);
+        }
+
+        // Holes in the pools, and a reused index with a fresh generation
+        for (uint32_t i = 0; i < entityCount; i += 7) registry.destroy(entities[i]);
+        entities[0] = registry.create();
+        registry.add<Tag>(entities[0], 0u);
+        registry.add<Position>(entities[0]);
+        registry.add<Velocity>(entities[0]);
+
+        const auto expected = [&](uint32_t i) -> uint32_t {
+            if (i == 0) return 1;
+            return (((i % 7) != 0) && ((i % 3) == 0) && ((i % 5) == 0));
+        };
+
+        std::vector<std::atomic<uint32_t>> visits(entityCount);
+        const auto check = [&]() {
+            size_t wrongCount = 0;
+            for (uint32_t i = 0; i < entityCount; ++i) wrongCount += (visits[i].exchange(0) != expected(i));
+            CHECK(wrongCount == 0);
+        };
+        const auto visit = [&](Entity entity, Tag &tag, Position &, Velocity &) {
+            if (registry.isAlive(entity) && (entities[tag.value] == entity)) visits[tag.value].fetch_add(1, std::memory_order_relaxed);
+        };
+
+        registry.forEach<Tag, Position, Velocity>(visit);
+        check();
+
+        // Listed in another order, the velocities still drive as the smallest pool
+        registry.forEach<Velocity, Position, Tag>([&](Entity entity, Velocity &velocity, Position &position, Tag &tag) {visit(entity, tag, position, velocity);});
+        check();
+
+        // Inline while the job system isn't running, then spread over its workers, with chunks smaller and bigger than the pools
+        for (const bool running: {false, true}) {
+            if (running) JobSystem::start(std::max<size_t>(JobSystem::getDefaultWorkerCount(), 2));
+
+            for (const size_t chunkSize: {size_t(1), size_t(64), EntityRegistry::defaultChunkSize, size_t(1'000'000)}) {
+                registry.parallelForEach<Tag, Position, Velocity>(visit, chunkSize);
+                check();
+            }
+
+            if (running) JobSystem::stop();
+        }
+
+        // Nothing to visit when a pool is empty
+        size_t emptyCount = 0;
+        registry.forEach<Tag, std::string>([&](Entity, Tag &, std::string &) {++emptyCount;});
+        CHECK(emptyCount == 0);
+    }
+}
+
+int main() {
+    testStaleHandles();
+    testSwapRemove();
+    testIteration();
+
+    if (checkFailureCount == 0) std::cout << "entityRegistryTest passed\n";
+    return CHECK_RESULT();
+}
\ No newline at end of file
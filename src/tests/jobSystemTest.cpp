@@ -0,0 +1,175 @@
+#include "../cg/jobSystem.hpp"
+#include "../cg/frameArena.hpp"
+#include "check.hpp"
+
+// Stress test of the work stealing 'JobSystem', no GL context needed. Races are timing dependent, so every part repeats many times.
+
+namespace {
+    // Owner and thieves fighting over a deque's last job: each job has to be taken exactly once, by the pop or by one steal
+    void testLastJobRace() {
+        using namespace CG;
+
+        constexpr size_t roundCount = 200'000, thiefCount = 3;
+
+        // Never dereferenced, the deque only moves the pointers around
+        std::vector<std::max_align_t> storage(roundCount);
+        std::vector<std::atomic<uint32_t>> takenCounts(roundCount);
+        const auto indexOf = [&](const Job *job) {return static_cast<size_t>(reinterpret_cast<const std::max_align_t *>(job) - storage.data());};
+
+        JobDeque deque;
+        std::atomic<bool> done = false;
+        {
+            std::vector<std::jthread> thieves;
+            for (size_t i = 0; i < thiefCount; ++i) {
+                thieves.emplace_back([&]() {
+                    while (!done.load(std::memory_order_acquire)) {
+                        if (const Job *const job = deque.steal()) takenCounts[indexOf(job)].fetch_add(1, std::memory_order_relaxed);
+                    }
+                });
+            }
+
+            // Mostly a single job at a time, so nearly every pop is the contended last one
+            for (size_t i = 0; i < roundCount;) {
+                const size_t pushCount = (((i % 7) == 0)? 2:1);
+                for (size_t j = 0; (j < pushCount) && (i < roundCount); ++j, ++i) CHECK(deque.push(reinterpret_cast<Job *>(&storage[i])));
+                while (const Job *const job = deque.pop()) takenCounts[indexOf(job)].fetch_add(1, std::memory_order_relaxed);
+            }
+
+            // Whatever a thief hasn't finished taking yet
+            while (deque.getSize() > 0) std::this_thread::yield();
+            done = true;
+        }
+
+        size_t wrongCount = 0;
+        for (const std::atomic<uint32_t> &count: takenCounts) wrongCount += (count.load() != 1);
+        CHECK(wrongCount == 0);
+    }
+
+    // Jobs depending on a counter start only once every job signaling it ran, including jobs queued after the dependents
+    void testContinuations() {
+        using namespace CG;
+
+        constexpr size_t roundCount = 500, jobCount = 32;
+
+        for (size_t round = 0; round < roundCount; ++round) {
+            JobCounter first, second, third;
+            std::atomic<size_t> firstDone = 0, secondDone = 0, earlyCount = 0;
+
+            for (size_t i = 0; i < jobCount; ++i) JobSystem::run([&]() {firstDone.fetch_add(1);}, &first);
+            for (size_t i = 0; i < jobCount; ++i) {
+                JobSystem::run([&]() {
+                    if (firstDone.load() != jobCount) earlyCount.fetch_add(1);
+                    secondDone.fetch_add(1);
+                }, &second, &first);
+            }
+
+            // Chained on a continuation, the last of the three can only see everything done
+            JobSystem::run([&]() {
+                if (secondDone.load() != jobCount) earlyCount.fetch_add(1);
+            }, &third, &second);
+
+            JobSystem::wait(third);
+            CHECK(earlyCount.load() == 0);
+            CHECK(first.isDone() && second.isDone());
+            JobSystem::wait(first);
+            JobSystem::wait(second);
+        }
+
+        // A dependency already done doesn't hold the job back
+        JobCounter done, signal;
+        bool ran = false;
+        JobSystem::run([&]() {ran = true;}, &signal, &done);
+        JobSystem::wait(signal);
+        CHECK(ran);
+    }
+
+    // Every worker blocked in a job's 'wait' at once still finishes, the waits run the inner jobs themselves
+    void testNestedWait() {
+        using namespace CG;
+
+        constexpr size_t outerCount = 64, innerCount = 64;
+
+        std::atomic<size_t> innerDone = 0;
+        JobCounter outer;
+        for (size_t i = 0; i < outerCount; ++i) {
+            JobSystem::run([&]() {
+                JobCounter inner;
+                for (size_t j = 0; j < innerCount; ++j) JobSystem::run([&]() {innerDone.fetch_add(1);}, &inner);
+                JobSystem::wait(inner);
+            }, &outer);
+        }
+        JobSystem::wait(outer);
+        CHECK(innerDone.load() == (outerCount * innerCount));
+
+        // Same through nested 'parallelFor's
+        std::vector<uint32_t> cells(256 * 256, 0);
+        JobSystem::parallelFor(256, [&](size_t begin, size_t end) {
+            for (size_t row = begin; row < end; ++row) {
+                JobSystem::parallelFor(256, [&](size_t columnBegin, size_t columnEnd) {
+                    for (size_t column = columnBegin; column < columnEnd; ++column) ++cells[(row * 256) + column];
+                }, 16);
+            }
+        }, 8);
+        CHECK(std::all_of(cells.begin(), cells.end(), [](uint32_t cell) {return (cell == 1);}));
+    }
+
+    // Queued from workers, run by the main thread's wait
+    void testMainThreadJobs() {
+        using namespace CG;
+
+        std::atomic<size_t> offMainThreadCount = 0, ranCount = 0;
+        JobCounter counter;
+        JobSystem::parallelFor(100, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                JobSystem::runOnMainThread([&]() {
+                    if (!JobSystem::isMainThread()) offMainThreadCount.fetch_add(1);
+                    ranCount.fetch_add(1);
+                }, &counter);
+            }
+        }, 1);
+        JobSystem::wait(counter);
+        CHECK(ranCount.load() == 100);
+        CHECK(offMainThreadCount.load() == 0);
+    }
+
+    // Once the job pool and queues grew to what the loop needs, a 'parallelFor' doesn't touch the heap on any thread
+    void testParallelForAllocations() {
+        using namespace CG;
+
+        std::vector<uint64_t> values(100'000);
+        const auto fill = [&]() {
+            JobSystem::parallelFor(values.size(), [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) values[i] = (i * i);
+            }, 1024);
+        };
+
+        for (size_t i = 0; i < 50; ++i) fill();
+        const size_t allocations = AllocationCounter::getCount();
+        for (size_t i = 0; i < 100; ++i) fill();
+        CHECK(AllocationCounter::getCount() == allocations);
+        CHECK(values[99'999] == (99'999ull * 99'999ull));
+    }
+}
+
+int main() {
+    using namespace CG;
+
+    testLastJobRace();
+
+    // At least two workers, so there's stealing even on a single core machine
+    JobSystem::start(std::max<size_t>(JobSystem::getDefaultWorkerCount(), 2));
+    testContinuations();
+    testNestedWait();
+    testMainThreadJobs();
+    if (AllocationCounter::isEnabled()) testParallelForAllocations();
+    JobSystem::stop();
+
+    // Without workers, everything runs inline on the caller
+    std::atomic<size_t> inlineCount = 0;
+    JobCounter counter;
+    JobSystem::run([&]() {inlineCount.fetch_add(1);}, &counter);
+    CHECK(counter.isDone() && (inlineCount.load() == 1));
+
+    if (checkFailureCount == 0) std::cout << "jobSystemTest passed\n";
+    return CHECK_RESULT();
+}
\ No newline at end of file
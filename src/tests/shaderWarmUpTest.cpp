@@ -0,0 +1,61 @@
+#include "../cg/window.hpp"
+#include "../cg/shader.hpp"
+#include "../cg/resourceQueue.hpp"
+#include "check.hpp"
+
+// 'Shader::warmUp' compiles the declared variants on a resource queue run by a worker thread, and 'getVariant' then hands those out instead of compiling.
+// Needs a GL context, made headless through OSMesa. Run from the repository root, the stages are the repo's own.
+
+int main() {
+    using namespace CG;
+
+    Window window("Shader Warm Up Test", 64, 64, {.headless = true, .contextApi = ContextApi::OSMesa});
+    if (!window.exists()) return 1;
+
+    const std::filesystem::path root = (std::filesystem::temp_directory_path() / "cgShaderWarmUpTest");
+    const std::filesystem::path path = (root / "warmUp.shader");
+    std::filesystem::create_directories(root);
+    std::ofstream(path) << "vertex: \"assets/shaderStages/basic.vert\"\n"
+                           "fragment: \"assets/shaderStages/basic.frag\"\n"
+                           "keywords: [ALPHA_TEST, FOG]\n"
+                           "warmUp: [[FOG], [ALPHA_TEST, FOG]]\n";
+
+    {
+        ResourceQueue queue;
+        Shader shader(path);
+
+        // As 'HotReloader' does, the queue runs on a thread of its own
+        std::jthread worker([&](std::stop_token stop) {
+            while (!stop.stop_requested()) {
+                queue.execute();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+
+        shader.warmUp(queue);
+        CHECK(shader.getVariantCount() == 0); // Only taken in by the calls below
+
+        const auto deadline = (std::chrono::steady_clock::now() + std::chrono::seconds(10));
+        while ((shader.getPendingWarmUpCount() > 0) && (std::chrono::steady_clock::now() < deadline)) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+        // Both sets compiled on the queue, asking for them compiles nothing more
+        CHECK(shader.getPendingWarmUpCount() == 0);
+        CHECK(shader.getVariantCount() == 2);
+        CHECK(shader.getVariant({"FOG"}).exists());
+        CHECK(shader.getVariant({"FOG", "ALPHA_TEST"}).exists());
+        CHECK(shader.getVariantCount() == 2);
+
+        // Warming up again queues nothing, a set that wasn't declared compiles on the spot
+        shader.warmUp(queue);
+        CHECK(shader.getPendingWarmUpCount() == 0);
+        CHECK(shader.getVariant({"ALPHA_TEST"}).exists());
+        CHECK(shader.getVariantCount() == 3);
+
+        worker = {}; // Stopped before the queue goes
+    }
+
+    std::filesystem::remove_all(root);
+
+    if (checkFailureCount == 0) std::cout << "shaderWarmUpTest passed\n";
+    return CHECK_RESULT();
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+#include "../cg/window.hpp"
+#include "../cg/texture.hpp"
+#include "../cg/hotReloader.hpp"
+#include "check.hpp"
+
+// Hot reload of a texture whose image changed size, which takes a new GL object: the texture keeps its pinned unit and sampling state.
+// Needs a GL context, made headless through OSMesa.
+
+namespace {
+    void writeImage(const std::filesystem::path &path, int width, int height, int channels) {
+        const std::vector<uint8_t> pixels((static_cast<size_t>(width) * height * channels), 0x80);
+        stbi_write_png(path.string().c_str(), width, height, channels, pixels.data(), (width * channels));
+    }
+}
+
+int main() {
+    using namespace CG;
+
+    Window window("Texture Reload Test", 64, 64, {.headless = true, .contextApi = ContextApi::OSMesa});
+    if (!window.exists()) return 1;
+
+    const std::filesystem::path root = (std::filesystem::temp_directory_path() / "cgTextureReloadTest");
+    const std::filesystem::path path = (root / "image.png");
+    std::filesystem::create_directories(root);
+    writeImage(path, 2, 2, 4);
+
+    constexpr int32_t pinnedUnit = 5;
+    {
+        Texture texture(path);
+        texture.slot(pinnedUnit);
+        texture.setMagnificationMode(TextureMagnificationMode::Nearest);
+
+        HotReloader reloader(root);
+        reloader.watch(texture, path);
+
+        // Bigger and without alpha, so the storage can't be reused
+        writeImage(path, 4, 2, 3);
+        std::filesystem::last_write_time(path, (std::filesystem::last_write_time(path) + std::chrono::seconds(1))); // For modification time polling
+
+        const auto deadline = (std::chrono::steady_clock::now() + std::chrono::seconds(10));
+        while ((reloader.getReloadCount() == 0) && (reloader.getFailureCount() == 0) && (std::chrono::steady_clock::now() < deadline)) {
+            reloader.update();
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        CHECK(reloader.getReloadCount() == 1);
+        CHECK((texture.getWidth() == 4) && (texture.getHeight() == 2) && (texture.getChannels() == 3));
+        CHECK(texture.getSlot() == pinnedUnit);
+        CHECK(texture.bind() == pinnedUnit);
+        CHECK(texture.getMagnificationMode() == TextureMagnificationMode::Nearest);
+
+        // The unit holds the new object, not the deleted one
+        int32_t boundId = 0;
+        glActiveTexture(GL_TEXTURE0 + pinnedUnit);
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &boundId);
+        CHECK(static_cast<uint32_t>(boundId) == texture.getId());
+
+        reloader.unwatch(texture);
+    }
+
+    std::filesystem::remove_all(root);
+
+    if (checkFailureCount == 0) std::cout << "textureReloadTest passed\n";
+    return CHECK_RESULT();
+}
\ No newline at end of file